@@ -34,6 +34,85 @@ void psxBiosLoadExecCdrom();
 
 int HleDispatchCall(uint32_t pc);
 void HleHookAfterLoadState(const char* game_code);
+// Notify the HLE that a controller was plugged/unplugged on port (0 or 1)
+void HlePadHotplug(int port);
+
+// Late-latched pad sampling (disabled by default)
+// Pad buffers are filled at the first guest access instead of VBlank. The emulator must install a read/write
+// watch on the ranges returned by HlePadGetWatchRanges (they change when the game calls PAD_init/InitPAD),
+// and call HlePadOnWatchHit before performing a watched access. Hits are cheap once the buffers are fresh.
+void HlePadSetLateLatch(int enable);
+int HlePadGetWatchRanges(uint32_t* addrs, uint32_t* sizes, int max);
+void HlePadOnWatchHit(uint32_t addr);
+
+// To be called by the emulator when a disc is inserted, swapped or removed. Rebuilds the filesystem index;
+// HLE disc reads otherwise assume the media didn't change.
+void psxFs_OnMediaChanged();
+
+// Directory of the persistent filesystem index cache (one file per disc). Empty or NULL disables the cache.
+void HleSetFsIndexCacheDir(const char* dir);
+// Directories are parsed when a path beneath them is first looked up. Meanwhile, background threads walk the
+// rest of the tree to complete the index (needed by sector lookups and the index cache): 4 on PCSX, 1
+// otherwise, as the other backends serialize reads. 0 only parses the directories looked up. On Mednafen the HLE
+// reads through the emulator's own CDIF, so the walk is done synchronously at boot instead.
+void HleSetFsIndexThreads(int count);
+// The indexes of the last discs used (4 by default) are kept in memory, so that swapping between the discs of
+// a multi-disc title doesn't parse them again. HleFsPrefetchPlaylist indexes the discs of a .m3u playlist in
+// the background (to be called at startup, PCSX and DuckStation only).
+void HleSetFsIndexLruSize(int discs);
+void HleFsPrefetchPlaylist(const char* m3u_path);
+// Capacity (in 2048-byte sectors) of the in-memory cache of HLE disc reads. 0 disables the cache.
+void HleSetFsSectorCacheSize(uint32_t sectors);
+// Number of worker threads of the async disc reads (2 by default). 0 serves async reads synchronously. Always 0
+// on Mednafen, where the HLE reads through the emulator's own CDIF (no CD prefetch or boot profile replay).
+void HleSetFsAsyncWorkers(int count);
+// Memory map the disc images opened by the HLE (PCSX), instead of reading them with pread. Off by default.
+void HleSetFsMmap(int enable);
+
+// File-aware prefetch for the emulator CD-ROM controller (enabled by default, needs the async workers).
+// The emulator reports every sector it reads; the rest of the file being read (then the next file on the
+// disc) is read ahead in the background. Mode 1/Mode 2 Form 1 data sectors can then be served from the
+// host cache with HleFsReadCachedSector (returns 0 on a miss).
+// lba is the sector number of the HLE (and of the ISO filesystem): it is relative to the start of track 1, ie.
+// the absolute LBA minus 150 on a standard disc (MSF 00:02:00 is sector 0). Controllers working on absolute
+// LBAs must convert them, other sectors would be prefetched and served.
+void HleSetFsCdPrefetch(int enable);
+void HleFsOnCdSectorRead(uint32_t lba);
+int HleFsReadCachedSector(uint32_t lba, void* dest);
+
+// Boot profile: the disc reads of the first seconds after boot are recorded next to the index cache (needs
+// HleSetFsIndexCacheDir), and replayed in the background ahead of the game on the following boots.
+// 30 seconds by default, 0 disables. HleFsFlushBootProfile saves a profile still being recorded.
+void HleSetFsBootProfileSeconds(int seconds);
+void HleFsFlushBootProfile();
+
+// CD-ROM BIOS calls (dev_cd_*, _96_Cd*, ReadSector, cdrom: files) transfer sectors straight into guest RAM. They
+// take the time of a 2x drive by default, instant load mode completes them without advancing the clock.
+void HleSetCdInstantLoad(int enable);
+
+// Host directory mount: "pcdrv:" and "host:" paths (open/read/lseek/close/firstfile/nextfile, Load/LoadExec) are
+// served read-only from this directory, matching names case insensitively. Empty or NULL disables the mount.
+// HleSetHostBootExe boots the given executable (eg. "pcdrv:\\MAIN.EXE") instead of the BOOT entry of SYSTEM.CNF.
+void HleSetHostMountDir(const char* dir);
+void HleSetHostBootExe(const char* path);
+
+// Code pre-warm (disabled by default): after an executable is loaded (boot, Load/LoadExec), the callback receives
+// its likely-hot entry points (entry point, registered event/IRQ handlers, most called jal targets), for the
+// recompiler to compile them ahead of the first jump, eg. on a background thread. The list is only valid during
+// the call.
+typedef void (*HleCodePrewarmCallback)(const uint32_t* addrs, int count, void* user);
+void HleSetCodePrewarmCallback(HleCodePrewarmCallback callback, void* user);
+
+// Startup profile: wall-clock time and disc bytes read by each phase of the last init (psxBiosInitFull) and
+// boot (psxBiosLoadExecCdrom), followed by the timings of the disc index build ("fs/index_parse", "fs/index_lut").
+// HleGetStartupReport fills up to max phases and returns the number of phases. HlePrintStartupReport logs it as JSON.
+typedef struct {
+    const char* name;
+    uint64_t    wall_us;
+    uint64_t    io_bytes;
+} HleStartupPhase;
+int HleGetStartupReport(HleStartupPhase* dest, int max);
+void HlePrintStartupReport();
 
 void psxBiosPrintCall(int table);
 
@@ -18,6 +18,8 @@ void psxBiosInitKernelDataStructure();
 // Debug function
 void psxBiosPrintEvents(); // Called from GDB
 void psxBiosPrintThreads(); // Called from GDB
+void psxBiosPrintIrqChain(); // Called from GDB
+void psxBiosPrintPadStats(); // Called from GDB
 
 extern uint8_t hleSoftCall;
 using HleYieldUid = uint32_t;
@@ -37,10 +39,107 @@ extern HLE_BIOS_TABLE biosC0;
 
 void softCall(uint32_t pc);
 
+// Yield engine (see HLE_ENABLE_YIELD in psxhle-emu-ifc.h)
+//
+// Kernel internal routines (exception handler, event delivery...) aren't reachable from a BIOS call
+// table, so they are resumed through a pseudo thunk.
+const uint32_t HLE_THUNK_KERNEL = 0x80;
+
+enum HleKernelCall : uint32_t {
+    HLE_KCALL_Exception = 0,
+    HLE_KCALL_Syscall,
+    HLE_KCALL_Interrupt,
+    HLE_KCALL_DeliverEvent,
+    HLE_KCALL_DeliverAsyncEvent,
+    HLE_KCALL_MAX
+};
+
+extern HLE_BIOS_TABLE biosKernel;
+
+// Saves the state of a suspended HLE call (plus current $ra) on the guest stack, and points $ra to the
+// magic return address of `resume`. The caller then sets pc0 to the guest code to run.
+void HleYieldPush(HleYieldUid resume, const uint32_t* state, uint32_t count);
+// Counterpart of HleYieldPush, called by the resumed HLE call. Restores $ra and the guest stack.
+void HleYieldPop(uint32_t* state, uint32_t count);
+// Resumes the HLE call identified by uid, and any further call that completes by returning to a magic address.
+void HleYieldResume(HleYieldUid uid);
+void HleYieldTrampoline();
+
+template <typename T>
+void HleYieldPush(HleYieldUid resume, const T& frame) {
+    static_assert(sizeof(T) % 4 == 0, "yield frame must be made of 32-bit words");
+    HleYieldPush(resume, (const uint32_t*)&frame, sizeof(T) / 4);
+}
+
+template <typename T>
+void HleYieldPop(T& frame) {
+    static_assert(sizeof(T) % 4 == 0, "yield frame must be made of 32-bit words");
+    HleYieldPop((uint32_t*)&frame, sizeof(T) / 4);
+}
+
+// IRQ handler chain (host copy of the G_HANDLERS lists, see psxbios_irq.cpp)
+struct IrqChainEntry {
+    uint32_t prio;
+    uint32_t node;          // PSX address of the HandlerInfo
+    uint32_t next;
+    uint32_t handler;
+    uint32_t verifier;
+    uint32_t noop_known;    // verifier returns 0 when (ISTAT & noop_mask) == 0
+    uint32_t noop_mask;
+};
+
+// Position in the chain. Made of 32-bit words so it can be saved in a yield frame.
+struct IrqChainCursor {
+    uint32_t prio;
+    uint32_t node;          // next node to visit (0 = end of the current priority list)
+    uint32_t index;         // hint in the flattened chain
+    uint32_t called;        // guest code ran since the last IrqChainNext
+};
+
+struct IrqChainStats {
+    uint64_t verifier_called;
+    uint64_t verifier_skipped;
+    uint64_t rebuilds;
+    uint64_t interrupt_fast;    // interrupts handled without saving the thread context
+    uint64_t interrupt_full;
+};
+extern IrqChainStats g_irq_chain_stats;
+
+void IrqChainRebuild();
+void IrqChainInvalidate();
+// checked: the chain was validated by IrqChainHasVerifier during this exception, and no guest code ran since
+IrqChainCursor IrqChainBegin(bool checked = false);
+// Returns the next entry whose verifier must be called. Verifiers that can't fire for the current ISTAT are skipped.
+bool IrqChainNext(IrqChainCursor& c, IrqChainEntry& e);
+// True if a verifier of the chain might return non-zero for this ISTAT value
+bool IrqChainHasVerifier(uint32_t istat);
+const IrqChainEntry* IrqChainGetEntries(uint32_t& count);
+
+// Pad sampling
+struct HlePadStats {
+    uint64_t samples;       // pad buffers updated (once per VBlank)
+    uint64_t gated;         // interrupts without VBlank, pads not polled
+    uint64_t transfers;     // PAD_transfer_block calls
+    uint64_t skipped_ports; // disconnected ports not probed
+    // Late latch
+    uint64_t latched_watch;     // buffers filled at the first guest access
+    uint64_t latched_callback;  // buffers filled before the VSync event callback
+    // Sampled-to-consumed latency (needs the emulator watch)
+    uint64_t frames_consumed;
+    uint64_t frames_unconsumed;
+    uint64_t latency_sum_us;
+    uint32_t latency_last_us;
+    uint32_t latency_max_us;
+};
+extern HlePadStats g_pad_stats;
+
 // Event
 EVCB* GetEVCB();
 void DeliverEvent(uint32_t ev, uint32_t spec);
+bool EventHasCallback(uint32_t ev, uint32_t spec);
+void DeliverEventNoCallback(uint32_t ev, uint32_t spec);
 void initEvents(uint32_t kernel_evcb);
+void initEventsYield();
 // Async Event
 void PostAsyncEvent(uint32_t ev, uint16_t spec, uint16_t port, uint16_t repeat = 1);
 void DeliverAsyncEvent();
@@ -64,6 +64,7 @@ enum class EVENT_MODE : uint32_t {
     NO_CALLBACK = 0x2000,
 };
 
+const uint32_t EVENT_CLASS_CDROM_HW  = 0xf000'0003;
 const uint32_t EVENT_CLASS_CARD_HW   = 0xf000'0011;
 const uint32_t EVENT_CLASS_CARD_BIOS = 0xf400'0001;
 const uint32_t EVENT_CLASS_TIMER     = 0xf200'0000;
@@ -73,6 +74,10 @@ const uint16_t EVENT_SPEC_INTERRUPT = 0x0002;
 const uint16_t EVENT_SPEC_END_IO    = 0x0004;
 const uint16_t EVENT_SPEC_TIMEOUT   = 0x0100;
 const uint16_t EVENT_SPEC_SYSCALL   = 0x4000;
+const uint16_t EVENT_SPEC_COMPLETE  = 0x0020;
+const uint16_t EVENT_SPEC_DATA_READY= 0x0040;
+const uint16_t EVENT_SPEC_DATA_END  = 0x0080;
+const uint16_t EVENT_SPEC_ERROR     = 0x8000;
 
 typedef struct {
     uint32_t ev;
@@ -119,6 +124,22 @@ typedef struct {
     uint32_t  mcfile;
 } FileDesc;
 
+// File control block of the device drivers (dev_cd_*)
+struct FCB {
+    uint32_t status;    // access mode, 0 if free
+    uint32_t diskid;
+    uint32_t trns_addr;
+    uint32_t trns_len;
+    uint32_t pos;
+    uint32_t flags;
+    uint32_t error;
+    uint32_t dcb;
+    uint32_t size;
+    uint32_t lba;       // first sector of the file
+    uint32_t fid;
+};
+static_assert(sizeof(FCB) == 0x2c);
+
 struct AsyncEventInfo {
     uint32_t ev;
     uint16_t spec;
@@ -131,6 +152,7 @@ struct AsyncEventInfo {
 };
 const uint16_t INVALID_REPEAT = 0xFFF; // 12 bits
 const uint16_t INVALID_PORT = 0xF; // 4 bits
+const uint16_t CDROM_PORT = 2; // busy bit of the CD-ROM, after the 2 card ports
 static_assert(sizeof(AsyncEventInfo) == 8);
 
 struct HandlerInfo {
@@ -169,6 +191,13 @@ struct HleState {
     uint32_t busy_card_info; // 1 bit per port (so 2 bits)
     // Change directory
     uint8_t pwd[32];
+    // Async events being delivered by the yield engine (HLE_ENABLE_YIELD)
+    uint32_t async_deliver_nb;
+    AsyncEventInfo async_deliver[128];
+    // CD-ROM
+    uint32_t cd_status;         // _96_CdGetStatus
+    uint32_t cd_seek_sector;    // target of _96_CdSeekL, advanced by _96_CdRead
+    uint32_t cd_head_sector;    // sector following the last read (seek timing)
 };
 
 extern HleState* g_hle;
@@ -41,10 +41,13 @@
 #include "StringTokenizer.h"
 #include "StringUtil.h"
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 #if !defined(HAS_ZLIB)
 #   define HAS_ZLIB         1
@@ -691,6 +694,7 @@ void psxBios_srand(HLE_BIOS_CALL_ARGS) { // 0x30
     pc0 = ra;
 }
 
+#if !HLE_ENABLE_YIELD
 static u32 qscmpfunc, qswidth;
 
 static inline int qscmp(char *a, char *b) {
@@ -807,6 +811,188 @@ void psxBios_qsort(HLE_BIOS_CALL_ARGS) { // 0x31
     INTERNAL_CP0_EXIT_CRITICAL_SECTION();
 }
 
+#else
+
+// The comparator can't be called from the middle of a recursive quicksort without a recursive
+// interpreter. Instead qsort_main is implemented as a state machine, resumed after each comparison, so
+// that the comparisons and swaps are the same as the recursive version. Its recursion (always into the
+// smaller partition) becomes an explicit stack of the partitions left to sort, at most log2(count) deep.
+enum QsortState : u32 {
+    QSORT_START,        // start: partition [a, l)
+    QSORT_SCAN,         // top of the partition loop
+    QSORT_CMP_LO,       // waiting for compare(i, lp)
+    QSORT_LOOP,         // loop: scan from the top
+    QSORT_CMP_HI,       // waiting for compare(hp, j)
+};
+
+static const u32 kQsortMaxDepth = 32;
+
+struct QsortFrame {
+    u32 width;
+    u32 cmpfunc;        // PSX address
+    u32 a, l;           // partition being sorted (PSX addresses, l is past the end)
+    u32 i, j, lp, hp;   // same as qsort_main
+    u32 state;
+    u32 depth;
+    u32 stack[kQsortMaxDepth][2];   // partitions left to sort, once the current one is done
+};
+
+static void qsortSwap(const QsortFrame& f, u32 x, u32 y) {
+    u8* a = (u8*)PSXM(x);
+    u8* b = (u8*)PSXM(y);
+    for (u32 n = 0; n < f.width; n++)
+        std::swap(a[n], b[n]);
+}
+
+// Same as q3exchange: i <- k <- j <- i
+static void qsortSwap3(const QsortFrame& f, u32 x, u32 y, u32 z) {
+    u8* i = (u8*)PSXM(x);
+    u8* j = (u8*)PSXM(y);
+    u8* k = (u8*)PSXM(z);
+    for (u32 n = 0; n < f.width; n++) {
+        u8 t = i[n];
+        i[n] = k[n];
+        k[n] = j[n];
+        j[n] = t;
+    }
+}
+
+// Advances the sort up to the next comparison (elements x and y). Returns false once the array is sorted.
+static bool qsortStep(QsortFrame& f, s32 cmp, u32& x, u32& y) {
+    const u32 w = f.width;
+    for (;;) {
+        switch (f.state) {
+            case QSORT_START: {
+                u32 n = f.l - f.a;
+                if (n <= w) {
+                    if (!f.depth)
+                        return false;
+                    f.depth--;
+                    f.a = f.stack[f.depth][0];
+                    f.l = f.stack[f.depth][1];
+                    break;
+                }
+                n = w * (n / (2 * w));
+                f.hp = f.lp = f.a + n;
+                f.i = f.a;
+                f.j = f.l - w;
+                f.state = QSORT_SCAN;
+                break;
+            }
+
+            case QSORT_SCAN:
+                if (f.i < f.lp) {
+                    f.state = QSORT_CMP_LO;
+                    x = f.i; y = f.lp;
+                    return true;
+                }
+                f.state = QSORT_LOOP;
+                break;
+
+            case QSORT_CMP_LO:
+                if (cmp == 0) {
+                    qsortSwap(f, f.i, f.lp -= w);
+                    f.state = QSORT_SCAN;
+                } else if (cmp < 0) {
+                    f.i += w;
+                    f.state = QSORT_SCAN;
+                } else {
+                    f.state = QSORT_LOOP;
+                }
+                break;
+
+            case QSORT_LOOP:
+                if (f.j > f.hp) {
+                    f.state = QSORT_CMP_HI;
+                    x = f.hp; y = f.j;
+                    return true;
+                }
+                if (f.i == f.lp) {
+                    // The smaller side first (the recursive call), the other one once it's done
+                    dbg_check(f.depth < kQsortMaxDepth);
+                    if (f.lp - f.a >= f.l - f.hp) {
+                        f.stack[f.depth][0] = f.a;
+                        f.stack[f.depth][1] = f.lp;
+                        f.a = f.hp + w;
+                    } else {
+                        f.stack[f.depth][0] = f.hp + w;
+                        f.stack[f.depth][1] = f.l;
+                        f.l = f.lp;
+                    }
+                    f.depth++;
+                    f.state = QSORT_START;
+                    break;
+                }
+                qsortSwap3(f, f.j, f.lp -= w, f.i);
+                f.j = f.hp -= w;
+                f.state = QSORT_SCAN;
+                break;
+
+            case QSORT_CMP_HI:
+            default:
+                if (cmp == 0) {
+                    qsortSwap(f, f.hp += w, f.j);
+                    f.state = QSORT_LOOP;
+                } else if (cmp > 0) {
+                    if (f.i == f.lp) {
+                        qsortSwap3(f, f.i, f.hp += w, f.j);
+                        f.i = f.lp += w;
+                        f.state = QSORT_LOOP;
+                    } else {
+                        qsortSwap(f, f.i, f.j);
+                        f.j -= w;
+                        f.i += w;
+                        f.state = QSORT_SCAN;
+                    }
+                } else {
+                    f.j -= w;
+                    f.state = QSORT_LOOP;
+                }
+                break;
+        }
+    }
+}
+
+void psxBios_qsort(HLE_BIOS_CALL_ARGS) { // 0x31
+    QsortFrame f;
+    s32 cmp = 0;
+
+    if (HleGetYieldState(huid) == 0) {
+        if (a1 < 2 || a2 == 0) {
+            pc0 = ra;
+            return;
+        }
+
+        // Same as the recursive version, IRQ are disabled during the sort to remove re-entrance from the equation
+        INTERNAL_CP0_ENTER_CRITICAL_SECTION();
+
+        f = {};
+        f.width = a2;
+        f.cmpfunc = a3;
+        f.a = a0;
+        f.l = a0 + a1 * a2;
+        f.state = QSORT_START;
+    } else {
+        // Resume after the comparator
+        HleYieldPop(f);
+        cmp = (s32)v0;
+    }
+
+    u32 x, y;
+    if (qsortStep(f, cmp, x, y)) {
+        HleYieldPush(HleMakeYieldUid(0xA0, 0x31, 1), f);
+        a0 = x;
+        a1 = y;
+        pc0 = f.cmpfunc;
+        return;
+    }
+
+    pc0 = ra;
+
+    INTERNAL_CP0_EXIT_CRITICAL_SECTION();
+}
+#endif
+
 void psxBios_malloc(HLE_BIOS_CALL_ARGS) { // 0x33
     u32 *chunk, *newchunk = NULL;
     u32 dsize = 0, csize, cstat;
@@ -1260,11 +1446,178 @@ extern bool         psxFs_LoadExecutableHeader(const char* path, PSX_EXE_HEADER&
 extern psdisc_sec_t psxFs_GetFileSector(const char* path);
 extern intmax_t     psxFs_GetFileSize(const char* path);
 extern bool         psxFs_ReadSectorData2048(void* dest,  psdisc_sec_t sector, int nSectors=1);
+extern bool         psxFs_GetBootInfo(PSX_BOOT_INFO& dest);
+extern void         psxFs_SetBootInfo(const PSX_BOOT_INFO& src);
+extern int          psxFs_SubmitRead(void* dest, psdisc_sec_t sector, int nSectors, psxFsReadCallback callback = {});
+extern bool         psxFs_WaitRead(int id);
+extern const uint8_t* psxFs_ReadSectorSpan2048(psdisc_sec_t sector, uint8_t* fallback);
+extern int          psxFs_SubmitExecutable(psdisc_sec_t sector, psxFsExeLayout layout, psxFsChunkCallback on_chunk = {});
+extern bool         psxFs_GetFileExtent(const char* path, psdisc_sec_t& sector, intmax_t& size);
+extern bool         psxFs_ListDirectory(const char* path, std::vector<psxFsDirEntry>& dest);
+extern bool         psxFs_ReadSpans(psdisc_sec_t sector, const psxFsSpan* spans, int nspans, const psxFsChunkCallback& on_chunk = {});
+extern bool         psxFs_IsHostPath(const char* path);
+extern int          psxFs_HostOpen(const char* path, intmax_t& size);
+extern void         psxFs_HostClose(int handle);
+extern void         psxFs_HostCloseAll();
+extern void         psxFs_HostCloseUnreferenced(const int* handles, int count);
+extern intmax_t     psxFs_HostRead(int handle, intmax_t pos, const psxFsSpan* spans, int nspans);
+extern bool         psxFs_HostListDirectory(const char* path, std::vector<psxFsDirEntry>& dest);
+extern uint64_t     psxFs_GetMediaBytesRead();
+extern void         psxFs_GetIndexTimings(uint64_t& parse_us, uint64_t& lut_us, uint64_t& io_bytes);
+
+// Host spans of a guest RAM range: the 2MB of physical RAM are mirrored over 8MB, so a range running past
+// its end continues at its start. Other regions (scratchpad) aren't split.
+static int GuestRamSpans(uint32_t addr, intmax_t size, psxFsSpan* spans, int max_spans) {
+    auto masked = addr & PS1_SegmentAddrMask;
+    if (masked >= PS1_RamMirrorSize) {
+        spans[0] = { PSXM(addr), size };
+        return 1;
+    }
+
+    if (size > PS1_RamPhysicalSize) {
+        PSXBIOS_LOG("ERROR: %jd bytes don't fit in RAM, truncated", JFMT(size));
+        size = PS1_RamPhysicalSize;
+    }
+
+    int count = 0;
+    auto phys = masked & (PS1_RamPhysicalSize - 1);
+    while (size > 0 && count < max_spans) {
+        auto len = std::min<intmax_t>(size, PS1_RamPhysicalSize - phys);
+        spans[count++] = { PSX_RAM_START + phys, len };
+        size -= len;
+        phys  = 0;
+    }
+    return count;
+}
+
+// Byte-swapped copy of the descriptor that follows the exe header.
+static EXEC_DESCRIPTOR ExeDescriptor(const uint8_t* hdr) {
+    EXEC_DESCRIPTOR tdesc;
+    memcpy(&tdesc, hdr + sizeof(PSX_EXE_HEADER), sizeof(tdesc));
+
+    for(size_t i=0; i<sizeof(tdesc) / 4; ++i) {
+        auto* val = (int32_t*)&tdesc + i;
+        StoreToLE(*val, *val);
+    }
+    return tdesc;
+}
+
+// Code pre-warm
+//
+// Once an executable is in RAM, the emulator can be handed its likely-hot entry points (HleSetCodePrewarmCallback)
+// to compile them before the CPU first reaches them: the entry point, the jal targets of the text (most called
+// first) and the event/IRQ handlers registered so far.
+
+static HleCodePrewarmCallback   s_prewarm_cb;
+static void*                    s_prewarm_user;
+static const size_t             kPrewarmMaxEntries = 1024;
+
+extern "C" void HleSetCodePrewarmCallback(HleCodePrewarmCallback callback, void* user) {
+    s_prewarm_cb   = callback;
+    s_prewarm_user = user;
+}
+
+static bool IsGuestRamCode(u32 addr) {
+    return addr && !(addr & 3) && (addr & PS1_SegmentAddrMask) < PS1_RamMirrorSize && !IsHlePC(addr);
+}
+
+static void PrewarmCode(const EXEC_DESCRIPTOR& tdesc) {
+    if (!s_prewarm_cb) return;
+
+    std::vector<u32> entries;
+    std::unordered_set<u32> seen;
+    auto add = [&](u32 addr) {
+        if (entries.size() < kPrewarmMaxEntries && IsGuestRamCode(addr) && seen.insert(addr).second) {
+            entries.push_back(addr);
+        }
+    };
+
+    add(tdesc._pc);
+
+    // Linear scan of the text for jal. Data words decoding as a jal are harmless: the targets must fall
+    // within the text, and compiling a few bogus blocks costs less than a hitch.
+    u32 text     = tdesc.t_addr & ~3u;
+    u32 text_end = text + std::min(tdesc.t_size, PS1_RamPhysicalSize);
+    std::unordered_map<u32, u32> calls;
+    for (u32 pc = text; pc < text_end; pc += 4) {
+        u32 insn = LoadFromLE(psxMu32ref(pc));
+        if ((insn >> 26) != 3) continue;
+        u32 target = ((pc + 4) & 0xf000'0000) | ((insn & 0x03ff'ffff) << 2);
+        if (target >= text && target < text_end) {
+            calls[target]++;
+        }
+    }
+    std::vector<std::pair<u32, u32>> targets(calls.begin(), calls.end());
+    std::sort(targets.begin(), targets.end(), [](const std::pair<u32, u32>& a, const std::pair<u32, u32>& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    // Handlers first, they run every frame
+    auto* evcb = GetEVCB();
+    for (u32 i = 0; i < EVCB_MAX; i++) {
+        if (evcb[i].status != EVENT_STATUS::FREE && evcb[i].mode == EVENT_MODE::CALLBACK) {
+            add(evcb[i].fhandler);
+        }
+    }
+    IrqChainBegin();
+    u32 count;
+    auto* chain = IrqChainGetEntries(count);
+    for (u32 i = 0; i < count; i++) {
+        add(chain[i].verifier);
+        add(chain[i].handler);
+    }
+
+    for (auto& target : targets) {
+        add(target.first);
+    }
+
+    PSXBIOS_LOG("code pre-warm: %d entry points (%d call targets)", (int)entries.size(), (int)targets.size());
+    s_prewarm_cb(entries.data(), (int)entries.size(), s_prewarm_user);
+}
+
+// Loads an executable from the host mount (pcdrv:): the header into hdr (2048 bytes), then the text straight
+// into guest RAM.
+static bool HostLoadExecutable(const char* path, uint8_t* hdr) {
+    intmax_t size;
+    int handle = psxFs_HostOpen(path, size);
+    if (handle < 0) {
+        return false;
+    }
+
+    psxFsSpan span = { hdr, 2048 };
+    bool ok = psxFs_HostRead(handle, 0, &span, 1) == 2048;
+    if (ok) {
+        auto tdesc = ExeDescriptor(hdr);
+        psxFsSpan spans[4];
+        int nspans = GuestRamSpans(tdesc.t_addr, tdesc.t_size, spans, countof(spans));
+        auto len = psxFs_HostRead(handle, 2048, spans, nspans);
+        if (len >= 0 && len < tdesc.t_size) {
+            PSXBIOS_LOG("WARNING: %s is truncated (%jd bytes of text out of %u)", path, JFMT(len), tdesc.t_size);
+        }
+        ok = len >= 0;
+    }
+    psxFs_HostClose(handle);
+    return ok;
+}
 
 void psxBios_Load(HLE_BIOS_CALL_ARGS) { // 0x42
     PSXBIOS_LOG("psxBios_%s: %s, %x", biosA0n[0x42], Ra0, a1);
 
     std::string path(Ra0);
+    if (psxFs_IsHostPath(Ra0)) {
+        uint8_t hdr[2048];
+        v0 = HostLoadExecutable(Ra0, hdr);
+        if (v0) {
+            if (auto* pa1 = (EXEC_DESCRIPTOR*)Ra1) {
+                memcpy(pa1, hdr + sizeof(PSX_EXE_HEADER), sizeof(*pa1));
+            }
+            ClearAllCaches();
+            PrewarmCode(ExeDescriptor(hdr));
+        }
+        pc0 = ra;
+        return;
+    }
+
     if (g_hle->version >= 2 && g_hle->pwd[0] == 'c') {
         std::string new_path((char*)g_hle->pwd);
         std::string::size_type pos = path.find(':');
@@ -1279,28 +1632,30 @@ void psxBios_Load(HLE_BIOS_CALL_ARGS) { // 0x42
     static_assert((sizeof(EXEC_DESCRIPTOR) + sizeof(PSX_EXE_HEADER)) == 76);
 
     if (auto sector = psxFs_GetFileSector(path.c_str())) {
-        uint8_t buf[2048];
-        psxFs_ReadSectorData2048(buf, sector);
-
-        EXEC_DESCRIPTOR tdesc = *(EXEC_DESCRIPTOR*)(buf + sizeof(PSX_EXE_HEADER));
-
-        if (auto* pa1 = (EXEC_DESCRIPTOR*)Ra1) {
-            *pa1 = tdesc;
+        // The text is streamed straight into guest RAM.
+        EXEC_DESCRIPTOR tdesc_le, tdesc;
+        auto text_read = psxFs_SubmitExecutable(sector, [&](const uint8_t* hdr, psxFsSpan* spans, int max_spans) {
+            memcpy(&tdesc_le, hdr + sizeof(PSX_EXE_HEADER), sizeof(tdesc_le));
+            tdesc = ExeDescriptor(hdr);
+            return GuestRamSpans(tdesc.t_addr, tdesc.t_size, spans, max_spans);
+        });
+
+        v0 = psxFs_WaitRead(text_read);
+        if (!v0) {
+            PSXBIOS_LOG("ERROR: can't read %s", path.c_str());
         }
 
-        for(size_t i=0; i<sizeof(tdesc) / 4; ++i) {
-            auto* val = (int32_t*)&tdesc + i;
-            StoreToLE(*val, *val);
+        // Only once the text is in: the descriptor may lie within the text range. Left untouched if the
+        // header couldn't be read.
+        if (auto* pa1 = (EXEC_DESCRIPTOR*)Ra1; v0 && pa1) {
+            *pa1 = tdesc_le;
         }
 
-        intmax_t text_addr = tdesc.t_addr;
-        intmax_t text_size = tdesc.t_size;
-        psxFs_ReadSectorData2048(PSXM(text_addr), sector+1, (text_size + 2047) / 2048);
-
-        // Code is updated in RAM, tell the emulator to flush everything
+        // Code is updated in RAM (even partially), tell the emulator to flush everything
         ClearAllCaches();
-
-        v0 = 1;
+        if (v0) {
+            PrewarmCode(tdesc);
+        }
     }
     else {
         v0 = 0;
@@ -1451,175 +1806,567 @@ void psxBios_get_cd_status(HLE_BIOS_CALL_ARGS) //a6
     pc0 = ra;
 }
 
-void psxBios__bu_init(HLE_BIOS_CALL_ARGS) { // 70
-    PSXBIOS_LOG("psxBios_%s", biosA0n[0x70]);
+// CD-ROM device (cdrom:). Files are resolved with the HLE disc index and their sectors are transferred straight
+// into guest RAM, instead of driving the emulated CD-ROM controller. The events the controller would raise are
+// posted to the async event queue.
+//
+// By default, calls take the time of a 2x drive (seek + 1/150s per sector). In instant load mode they don't
+// advance the clock at all.
 
-    // This call shall init the 2 ports. But we send event once, all games boot fine
-    // so let's keep this behavior and put an invalid port number
-    uint16_t port = INVALID_PORT;
+static bool s_cd_instant_load = false;
 
-#if HLE_ENABLE_YIELD
-    // Impl Note: honestly this would be easier rewritten as MIPS assembly.
-    //   It's just two JALs, but in order to maintain stack-engine state info at the HLE
-    //   level, we need to implement a ton of paperwork that the interpreter would simply
-    //   handle for us via its own MIPS state machine. --jstine
+extern "C" void HleSetCdInstantLoad(int enable) {
+    s_cd_instant_load = !!enable;
+}
 
-    int baseState = SCRI_psxBios__bu_init_00;
-    PostAsyncEvent(baseState++, EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO, port);
-    PostAsyncEvent(baseState++, EVENT_CLASS_CARD_BIOS, EVENT_SPEC_END_IO, port);
+static const u64 kCdClock       = 33868800;
+static const u64 kCdSectorTicks = kCdClock / 150;
+static const u64 kCdSeekTicks   = kCdClock / 20;    // skipped by sequential reads
 
-#else
-    PostAsyncEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO, port);
-    PostAsyncEvent(EVENT_CLASS_CARD_BIOS, EVENT_SPEC_END_IO, port);
+static const uint32_t kCdStatMotorOn = 0x02;
 
-    pc0 = ra;
-#endif
+static void CdAdvanceClock(psdisc_sec_t sector, intmax_t nSectors) {
+    if (!s_cd_instant_load) {
+        u64 ticks = nSectors * kCdSectorTicks;
+        if (sector != g_hle->cd_head_sector) {
+            ticks += kCdSeekTicks;
+        }
+        AdvanceClock(ticks);
+    }
+    g_hle->cd_head_sector = sector + nSectors;
 }
 
-void psxBios__96_init(HLE_BIOS_CALL_ARGS) { // 71
-    PSXBIOS_LOG("psxBios_%s", biosA0n[0x71]);
+// Reads len bytes at offset pos of the data starting at sector into guest memory. Whole sectors are read in
+// place, only an unaligned head goes through a bounce buffer.
+static bool CdReadToGuest(psdisc_sec_t sector, intmax_t pos, uint32_t addr, intmax_t len) {
+    if (len <= 0) return true;
 
-    pc0 = ra;
-}
+    psxFsSpan spans[4];
+    int nspans = GuestRamSpans(addr, len, spans, countof(spans));
 
-void psxBios__96_remove(HLE_BIOS_CALL_ARGS) { // 72
-    PSXBIOS_LOG("psxBios_%s", biosA0n[0x72]);
+    sector += pos / 2048;
+    CdAdvanceClock(sector, (pos % 2048 + len + 2047) / 2048);
 
-    // In theory, bios shall allocate some events for the CDrom, we don't need them
-    // However it breaks control in "007 The World Is Not Enough" in a subtle way
-    //
-    // Note: so far, events can't always be deleted because there weren't allocated in the first place
-    // (which must be done in psxBios__96_init and others init/boot part that would init the CDrom)
-    //
-    // Full story: here a quick description of game insanity
-    // * close all events handler (even the one that are owned by the bios) (likely with a loop)
-    // * open new events for input, which will take the first slots
-    // * call this bios_call and expect (the bios) to remove previous events (owned by the game...)
-    // * open new events for input again
-    if (s_remove_cdrom_events) {
-        for (u32 i = 0; i < 5; i++)
-            setOpenEventStatus(i, EVENT_STATUS::FREE);
+    int si = 0;
+    if (auto head = pos % 2048) {
+        uint8_t buf[2048];
+        auto* src = psxFs_ReadSectorSpan2048(sector, buf);
+        if (!src) return false;
+
+        src += head;
+        intmax_t avail = 2048 - head;
+        while (avail > 0 && si < nspans) {
+            auto n = std::min(avail, spans[si].len);
+            memcpy(spans[si].dest, src, n);
+            spans[si].dest = (uint8_t*)spans[si].dest + n;
+            spans[si].len -= n;
+            src   += n;
+            avail -= n;
+            if (!spans[si].len) ++si;
+        }
+        ++sector;
     }
 
-    pc0 = ra;
+    return si == nspans || psxFs_ReadSpans(sector, spans + si, nspans - si);
 }
 
-void psxBios_SetConf(HLE_BIOS_CALL_ARGS) { // 9c
-    PSXBIOS_LOG("psxBios_%s: %x, %x, %x", biosA0n[0x9c], a0, a1, a2);
+// Guest path to the disc path: cdrom paths without a leading separator are relative to the cd() directory.
+static std::string CdResolvePath(const char* path) {
+    auto* colon = strchr(path, ':');
+    auto* rel   = colon ? colon + 1 : path;
+    if (rel[0] == '\\' || rel[0] == '/' || strncmp((char*)g_hle->pwd, "cdrom", 5)) {
+        return rel;
+    }
 
-    EVCB_MAX = a0;
-    TCB_MAX = a1;
-    g_hle->initial_sp = a2;
+    std::string dir((char*)g_hle->pwd);
+    dir = dir.substr(dir.find(':') + 1);
+    if (!dir.empty() && dir.back() != '\\' && dir.back() != '/') {
+        dir += '\\';
+    }
+    return dir + rel;
+}
 
-    psxBiosInitKernelDataStructure();
+// Splits "dir\pattern" and matches file names against the pattern ('?' and '*', case insensitive). The
+// revision suffix is ignored on both sides.
+static void CdSplitPattern(const std::string& path, std::string& dir, std::string& pattern) {
+    auto sep = path.find_last_of("\\/:");
+    dir     = sep == std::string::npos ? std::string() : path.substr(0, path[sep] == ':' ? sep + 1 : sep);
+    pattern = sep == std::string::npos ? path : path.substr(sep + 1);
+    auto rev = pattern.find(';');
+    if (rev != std::string::npos) {
+        pattern.resize(rev);
+    }
+}
 
-    pc0 = ra;
+static bool CdMatchName(const char* pattern, const char* name) {
+    for (; *pattern; ++pattern, ++name) {
+        if (*pattern == '*') return true;
+        if (!*name) return false;
+        if (*pattern != '?' && toupper((u8)*pattern) != toupper((u8)*name)) return false;
+    }
+    return !*name;
 }
 
-void psxBios_GetConf(HLE_BIOS_CALL_ARGS) { // 9d
-    PSXBIOS_LOG("psxBios_%s: %x, %x, %x", biosA0n[0x9d], a0, a1, a2);
+// Listing of the last firstfile, kept until it's exhausted (or another one starts). It's rebuilt if the
+// guest state doesn't match it (nfile reset by firstfile, or a state load).
+static std::string                  s_dev_listing_ffile;
+static std::string                  s_dev_listing_pattern;
+static std::vector<psxFsDirEntry>   s_dev_listing;
 
-    StoreToLE(psxMu32ref(a0), EVCB_MAX);
-    StoreToLE(psxMu32ref(a1), TCB_MAX);
-    StoreToLE(psxMu32ref(a2), g_hle->initial_sp);
+// Fills the guest DIRENTRY with the next entry of the directory listing (disc or host mount) matching
+// g_hle->ffile, starting at entry g_hle->nfile. returns false once the listing is exhausted.
+static bool DevNextFile(u32 _dir) {
+    bool host = psxFs_IsHostPath(g_hle->ffile);
+    auto& list    = s_dev_listing;
+    auto& pattern = s_dev_listing_pattern;
 
-    pc0 = ra;
+    if (g_hle->nfile == 0 || s_dev_listing_ffile != g_hle->ffile) {
+        std::string dir;
+        CdSplitPattern(host ? std::string(g_hle->ffile) : CdResolvePath(g_hle->ffile), dir, pattern);
+        s_dev_listing_ffile = g_hle->ffile;
+        if (!(host ? psxFs_HostListDirectory(dir.c_str(), list) : psxFs_ListDirectory(dir.c_str(), list))) {
+            s_dev_listing_ffile.clear();
+            return false;
+        }
+    }
+
+    while (g_hle->nfile < list.size()) {
+        auto& ent = list[g_hle->nfile++];
+        if (!CdMatchName(pattern.c_str(), ent.name)) continue;
+
+        auto* entry = (DIRENTRY*)PSXM(_dir);
+        memset(entry, 0, sizeof(*entry));
+        snprintf(entry->name, sizeof(entry->name), "%s%s", ent.name, ent.is_dir || host ? "" : ";1");
+        entry->attr = ent.is_dir ? 0x10 : 0;
+        entry->size = ent.size;
+        entry->head = ent.sector;
+        return true;
+    }
+    s_dev_listing_ffile.clear();
+    list.clear();
+    return false;
+}
+
+// File descriptors of the disc files (B0 open), after the memory cards
+static const u32 kCdFirstFd = 4;
+static const u32 kCdLastFd  = 16;
+
+// Opens a disc file into a FileDesc: the mode field holds the file size (files are read-only), mcfile the
+// first sector and offset the read position.
+static bool CdOpen(FileDesc& fd, const char* path) {
+    psdisc_sec_t sector;
+    intmax_t size;
+    auto disc_path = CdResolvePath(path);
+    if (!psxFs_GetFileExtent(disc_path.c_str(), sector, size)) {
+        return false;
+    }
+    snprintf(fd.name, sizeof(fd.name), "%s", disc_path.c_str());
+    fd.mode   = (uint32_t)size;
+    fd.offset = 0;
+    fd.mcfile = (uint32_t)sector;
+    return true;
+}
+
+// returns the number of bytes read, -1 on error
+static int CdRead(FileDesc& fd, uint32_t addr, int32_t len) {
+    auto size = (int32_t)fd.mode;
+    len = std::max(0, std::min(len, size - (int32_t)fd.offset));
+    if (!CdReadToGuest(fd.mcfile, fd.offset, addr, len)) {
+        PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_ERROR, CDROM_PORT);
+        return -1;
+    }
+    fd.offset += len;
+    PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_DATA_END, CDROM_PORT);
+    return len;
+}
+
+// File descriptors of the host mount files (B0 open), stored like the disc files but mcfile is the host handle.
+static const u32 kHostFirstFd = 16;
+static const u32 kHostLastFd  = 32;
+
+static bool HostOpen(FileDesc& fd, const char* path) {
+    intmax_t size;
+    int handle = psxFs_HostOpen(path, size);
+    if (handle < 0) {
+        return false;
+    }
+    snprintf(fd.name, sizeof(fd.name), "%s", path);
+    fd.mode   = (uint32_t)size;
+    fd.offset = 0;
+    fd.mcfile = (uint32_t)handle;
+    return true;
+}
+
+// After a state load: the host files no guest fd refers to anymore are closed. Stale fds of the state are
+// rejected by the host mount on their next read.
+static void HostInvalidateFiles() {
+    int handles[kHostLastFd - kHostFirstFd];
+    int count = 0;
+    for (u32 fd = kHostFirstFd; fd < kHostLastFd; fd++) {
+        if (g_hle->FDesc[fd].name[0]) {
+            handles[count++] = (int)g_hle->FDesc[fd].mcfile;
+        }
+    }
+    psxFs_HostCloseUnreferenced(handles, count);
 }
 
-void psxBios_SetMem(HLE_BIOS_CALL_ARGS) { // 9f
-    u32 nx = Read_MEMCTRL2();
+// returns the number of bytes read, -1 on error
+static int HostRead(FileDesc& fd, uint32_t addr, int32_t len) {
+    auto size = (int32_t)fd.mode;
+    len = std::max(0, std::min(len, size - (int32_t)fd.offset));
 
-    PSXBIOS_LOG("psxBios_%s: %x, %x", biosA0n[0x9f], a0, a1);
+    psxFsSpan spans[4];
+    int nspans = GuestRamSpans(addr, len, spans, countof(spans));
+    auto res = psxFs_HostRead((int)fd.mcfile, fd.offset, spans, nspans);
+    if (res < 0) {
+        return -1;
+    }
+    fd.offset += (uint32_t)res;
+    return (int)res;
+}
 
-    switch(a0) {
-        case 2:
-            Write_MEMCTRL2(nx);
-            psxMu32ref(0x060) = a0;
-            SysPrintf("Change effective memory : %d MBytes",a0);
-            break;
+/*
+ *	int dev_cd_open(struct FCB *fcb, char *path, int mode);
+ */
 
-        case 8:
-            Write_MEMCTRL2(nx | 0x300);
-            psxMu32ref(0x060) = a0;
-            SysPrintf("Change effective memory : %d MBytes",a0);
+void psxBios_dev_cd_open(HLE_BIOS_CALL_ARGS) { // 5f
+    auto* fcb = (FCB*)Ra0;
 
-        default:
-            SysPrintf("Effective memory must be 2/8 MBytes");
-        break;
+    PSXBIOS_LOG("psxBios_%s: %s, %x", biosA0n[0x5f], Ra1, a2);
+
+    psdisc_sec_t sector;
+    intmax_t size;
+    auto path = CdResolvePath(Ra1);
+    if (psxFs_GetFileExtent(path.c_str(), sector, size)) {
+        fcb->size   = (uint32_t)size;
+        fcb->lba    = (uint32_t)sector;
+        fcb->pos    = 0;
+        fcb->error  = 0;
+        v0 = 0;
+    }
+    else {
+        fcb->error = 2; // ENOENT
+        v0 = -1;
     }
 
     pc0 = ra;
 }
 
-void psxBios__card_info(HLE_BIOS_CALL_ARGS) { // ab
-    PSXBIOS_LOG("psxBios_%s: %x", biosA0n[0xab], a0);
-
-    uint16_t port = a0 >> 4;
-    uint32_t port_flag = (1u << port);
+/*
+ *	int dev_cd_read(struct FCB *fcb, void *dst, int len);
+ */
 
-    if (g_hle->busy_card_info & port_flag) {
-        SysErrorPrintf("pending card_info, failed to register new cmd");
-        v0 = 0;
-        pc0 = ra;
-        return;
-    }
-    g_hle->busy_card_info |= port_flag;
+void psxBios_dev_cd_read(HLE_BIOS_CALL_ARGS) { // 60
+    auto* fcb = (FCB*)Ra0;
 
-    u32 ret;
-    g_hle->card_active_chan = a0;
+    PSXBIOS_LOG("psxBios_%s: %x, %x, %x", biosA0n[0x60], a0, a1, a2);
 
-    switch (port) {
-    case 0x0:
-    case 0x1:
-        ret = 0x2;
-        if (!VmcEnabled(port & 1))
-            ret = 0x8;
-        break;
-    default:
-        PSXBIOS_LOG("psxBios_%s: UNKNOWN PORT 0x%x", biosA0n[0xab], g_hle->card_active_chan);
-        ret = 0x11;
-        break;
+    auto len = std::max(0, std::min((int32_t)a2, (int32_t)(fcb->size - fcb->pos)));
+    if (CdReadToGuest(fcb->lba, fcb->pos, a1, len)) {
+        fcb->pos += len;
+        PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_DATA_END, CDROM_PORT);
+        v0 = len;
+    }
+    else {
+        fcb->error = 5; // EIO
+        PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_ERROR, CDROM_PORT);
+        v0 = -1;
     }
 
-    if (!VmcEnabled(0) && !VmcEnabled(1))
-        ret = 0x8;
+    pc0 = ra;
+}
 
-    // Game (Future cops LAPD) calls card_info from the handler of the event
-    // EVENT_CLASS_CARD_HW/0x4 so I doubt that event must be generated here
-    PostAsyncEvent(EVENT_CLASS_CARD_BIOS, 1 << ret, port);
-    PostAsyncEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO, port);
+void psxBios_dev_cd_close(HLE_BIOS_CALL_ARGS) { // 61
+    PSXBIOS_LOG("psxBios_%s: %x", biosA0n[0x61], a0);
 
-    v0 = 1; pc0 = ra;
+    v0 = 0;
+    pc0 = ra;
 }
 
-void psxBios__card_load(HLE_BIOS_CALL_ARGS) { // ac
-    PSXBIOS_LOG("psxBios_%s: %x", biosA0n[0xac], a0);
-
-    g_hle->card_active_chan = a0;
-    uint16_t port = g_hle->card_active_chan >> 4;
+/*
+ *	struct DIRENTRY* dev_cd_firstfile(struct FCB *fcb, char *path, struct DIRENTRY *dir);
+ */
 
-    // Load will read all memory card sector, so it shall trigger multiple (36?) EVENT_CLASS_CARD_HW events
-    // At the end of operation a EVENT_CLASS_CARD_BIOS is generated
-    PostAsyncEvent(EVENT_CLASS_CARD_BIOS, EVENT_SPEC_END_IO, port);
-    // Due to async nature a EVENT_CLASS_CARD_HW might remain (Police LPAD expect this extra event to load mcard)
-    PostAsyncEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO, port);
+void psxBios_dev_cd_firstfile(HLE_BIOS_CALL_ARGS) { // 62
+    PSXBIOS_LOG("psxBios_%s: %s", biosA0n[0x62], Ra1);
 
-    v0 = 1; pc0 = ra;
+    snprintf(g_hle->ffile, sizeof(g_hle->ffile), "cdrom:%s", Ra1);
+    g_hle->nfile = 0;
+    v0 = DevNextFile(a2) ? a2 : 0;
+    pc0 = ra;
 }
 
-void psxBios__card_auto(HLE_BIOS_CALL_ARGS) { // 0xAD
-    PSXBIOS_LOG("psxBios_%s", biosA0n[0xAD]);
+/*
+ *	struct DIRENTRY* dev_cd_nextfile(struct FCB *fcb, struct DIRENTRY *dir);
+ */
+
+void psxBios_dev_cd_nextfile(HLE_BIOS_CALL_ARGS) { // 63
+    PSXBIOS_LOG("psxBios_%s: %x", biosA0n[0x63], a1);
 
+    v0 = DevNextFile(a1) ? a1 : 0;
     pc0 = ra;
 }
 
-/* System calls B0 */
+/*
+ *	int dev_cd_chdir(struct FCB *fcb, char *path);
+ */
 
-void psxBios_SysMalloc(HLE_BIOS_CALL_ARGS) { // 00
-    // Allocation shall happen only once at init
-    // so let's not bother to support free
-    // Add a check if the continuous allocator is failling
-    rel_check(g_hle->kheap_size > a0);
+void psxBios_dev_cd_chdir(HLE_BIOS_CALL_ARGS) { // 64
+    PSXBIOS_LOG("psxBios_%s: %s", biosA0n[0x64], Ra1);
+
+    snprintf((char*)g_hle->pwd, sizeof(g_hle->pwd), "cdrom:%s", Ra1);
+    v0 = 1;
+    pc0 = ra;
+}
+
+/*
+ *	int _96_CdSeekL(u8 *msf);
+ */
+
+void psxBios__96_CdSeekL(HLE_BIOS_CALL_ARGS) { // 78
+    auto* msf = (u8*)Ra0;
+    auto bcd = [](u8 v) { return (v >> 4) * 10 + (v & 0xf); };
+
+    PSXBIOS_LOG("psxBios_%s: %02x:%02x:%02x", biosA0n[0x78], msf[0], msf[1], msf[2]);
+
+    // 2 seconds of pregap before LBA 0
+    g_hle->cd_seek_sector = (bcd(msf[0]) * 60 + bcd(msf[1])) * 75 + bcd(msf[2]) - 150;
+    g_hle->cd_status |= kCdStatMotorOn;
+    PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_COMPLETE, CDROM_PORT);
+
+    v0 = 1;
+    pc0 = ra;
+}
+
+/*
+ *	int _96_CdGetStatus(u8 *status);
+ */
+
+void psxBios__96_CdGetStatus(HLE_BIOS_CALL_ARGS) { // 7c
+    PSXBIOS_LOG("psxBios_%s", biosA0n[0x7c]);
+
+    *(u8*)Ra0 = (u8)g_hle->cd_status;
+    v0 = 1;
+    pc0 = ra;
+}
+
+/*
+ *	int _96_CdRead(int count, void *dst, int mode);
+ */
+
+void psxBios__96_CdRead(HLE_BIOS_CALL_ARGS) { // 7e
+    PSXBIOS_LOG("psxBios_%s: %d, %x, %x", biosA0n[0x7e], a0, a1, a2);
+
+    // Only 2048-byte data sectors come from the disc index (mode bit 5 selects 2340-byte sectors)
+    if (a2 & 0x20) {
+        PSXBIOS_LOG("ERROR: raw sector reads aren't supported");
+        PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_ERROR, CDROM_PORT);
+        v0 = 0;
+        pc0 = ra;
+        return;
+    }
+
+    auto sector = g_hle->cd_seek_sector;
+    g_hle->cd_status |= kCdStatMotorOn;
+    if (CdReadToGuest(sector, 0, a1, (intmax_t)a0 * 2048)) {
+        g_hle->cd_seek_sector += a0;
+        PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_DATA_END, CDROM_PORT);
+        v0 = 1;
+    }
+    else {
+        PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_ERROR, CDROM_PORT);
+        v0 = 0;
+    }
+
+    pc0 = ra;
+}
+
+void psxBios__96_CdStop(HLE_BIOS_CALL_ARGS) { // 85
+    PSXBIOS_LOG("psxBios_%s", biosA0n[0x85]);
+
+    g_hle->cd_status &= ~kCdStatMotorOn;
+    v0 = 1;
+    pc0 = ra;
+}
+
+/*
+ *	int ReadSector(int count, int sector, void *buffer);
+ */
+
+void psxBios_ReadSector(HLE_BIOS_CALL_ARGS) { // a5
+    PSXBIOS_LOG("psxBios_%s: %d, %d, %x", biosA0n[0xa5], a0, a1, a2);
+
+    if (CdReadToGuest(a1, 0, a2, (intmax_t)a0 * 2048)) {
+        PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_DATA_END, CDROM_PORT);
+        v0 = a0;
+    }
+    else {
+        PostAsyncEvent(EVENT_CLASS_CDROM_HW, EVENT_SPEC_ERROR, CDROM_PORT);
+        v0 = -1;
+    }
+
+    pc0 = ra;
+}
+
+void psxBios__bu_init(HLE_BIOS_CALL_ARGS) { // 70
+    PSXBIOS_LOG("psxBios_%s", biosA0n[0x70]);
+
+    // This call shall init the 2 ports. But we send event once, all games boot fine
+    // so let's keep this behavior and put an invalid port number
+    uint16_t port = INVALID_PORT;
+
+    // Events are delivered asynchronously (on the next interrupt), so nothing to yield here
+    PostAsyncEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO, port);
+    PostAsyncEvent(EVENT_CLASS_CARD_BIOS, EVENT_SPEC_END_IO, port);
+
+    pc0 = ra;
+}
+
+void psxBios__96_init(HLE_BIOS_CALL_ARGS) { // 71
+    PSXBIOS_LOG("psxBios_%s", biosA0n[0x71]);
+
+    g_hle->cd_status = kCdStatMotorOn;
+    pc0 = ra;
+}
+
+void psxBios__96_remove(HLE_BIOS_CALL_ARGS) { // 72
+    PSXBIOS_LOG("psxBios_%s", biosA0n[0x72]);
+
+    // In theory, bios shall allocate some events for the CDrom, we don't need them
+    // However it breaks control in "007 The World Is Not Enough" in a subtle way
+    //
+    // Note: so far, events can't always be deleted because there weren't allocated in the first place
+    // (which must be done in psxBios__96_init and others init/boot part that would init the CDrom)
+    //
+    // Full story: here a quick description of game insanity
+    // * close all events handler (even the one that are owned by the bios) (likely with a loop)
+    // * open new events for input, which will take the first slots
+    // * call this bios_call and expect (the bios) to remove previous events (owned by the game...)
+    // * open new events for input again
+    if (s_remove_cdrom_events) {
+        for (u32 i = 0; i < 5; i++)
+            setOpenEventStatus(i, EVENT_STATUS::FREE);
+    }
+
+    pc0 = ra;
+}
+
+void psxBios_SetConf(HLE_BIOS_CALL_ARGS) { // 9c
+    PSXBIOS_LOG("psxBios_%s: %x, %x, %x", biosA0n[0x9c], a0, a1, a2);
+
+    EVCB_MAX = a0;
+    TCB_MAX = a1;
+    g_hle->initial_sp = a2;
+
+    psxBiosInitKernelDataStructure();
+
+    pc0 = ra;
+}
+
+void psxBios_GetConf(HLE_BIOS_CALL_ARGS) { // 9d
+    PSXBIOS_LOG("psxBios_%s: %x, %x, %x", biosA0n[0x9d], a0, a1, a2);
+
+    StoreToLE(psxMu32ref(a0), EVCB_MAX);
+    StoreToLE(psxMu32ref(a1), TCB_MAX);
+    StoreToLE(psxMu32ref(a2), g_hle->initial_sp);
+
+    pc0 = ra;
+}
+
+void psxBios_SetMem(HLE_BIOS_CALL_ARGS) { // 9f
+    u32 nx = Read_MEMCTRL2();
+
+    PSXBIOS_LOG("psxBios_%s: %x, %x", biosA0n[0x9f], a0, a1);
+
+    switch(a0) {
+        case 2:
+            Write_MEMCTRL2(nx);
+            psxMu32ref(0x060) = a0;
+            SysPrintf("Change effective memory : %d MBytes",a0);
+            break;
+
+        case 8:
+            Write_MEMCTRL2(nx | 0x300);
+            psxMu32ref(0x060) = a0;
+            SysPrintf("Change effective memory : %d MBytes",a0);
+
+        default:
+            SysPrintf("Effective memory must be 2/8 MBytes");
+        break;
+    }
+
+    pc0 = ra;
+}
+
+void psxBios__card_info(HLE_BIOS_CALL_ARGS) { // ab
+    PSXBIOS_LOG("psxBios_%s: %x", biosA0n[0xab], a0);
+
+    uint16_t port = a0 >> 4;
+    uint32_t port_flag = (1u << port);
+
+    if (g_hle->busy_card_info & port_flag) {
+        SysErrorPrintf("pending card_info, failed to register new cmd");
+        v0 = 0;
+        pc0 = ra;
+        return;
+    }
+    g_hle->busy_card_info |= port_flag;
+
+    u32 ret;
+    g_hle->card_active_chan = a0;
+
+    switch (port) {
+    case 0x0:
+    case 0x1:
+        ret = 0x2;
+        if (!VmcEnabled(port & 1))
+            ret = 0x8;
+        break;
+    default:
+        PSXBIOS_LOG("psxBios_%s: UNKNOWN PORT 0x%x", biosA0n[0xab], g_hle->card_active_chan);
+        ret = 0x11;
+        break;
+    }
+
+    if (!VmcEnabled(0) && !VmcEnabled(1))
+        ret = 0x8;
+
+    // Game (Future cops LAPD) calls card_info from the handler of the event
+    // EVENT_CLASS_CARD_HW/0x4 so I doubt that event must be generated here
+    PostAsyncEvent(EVENT_CLASS_CARD_BIOS, 1 << ret, port);
+    PostAsyncEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO, port);
+
+    v0 = 1; pc0 = ra;
+}
+
+void psxBios__card_load(HLE_BIOS_CALL_ARGS) { // ac
+    PSXBIOS_LOG("psxBios_%s: %x", biosA0n[0xac], a0);
+
+    g_hle->card_active_chan = a0;
+    uint16_t port = g_hle->card_active_chan >> 4;
+
+    // Load will read all memory card sector, so it shall trigger multiple (36?) EVENT_CLASS_CARD_HW events
+    // At the end of operation a EVENT_CLASS_CARD_BIOS is generated
+    PostAsyncEvent(EVENT_CLASS_CARD_BIOS, EVENT_SPEC_END_IO, port);
+    // Due to async nature a EVENT_CLASS_CARD_HW might remain (Police LPAD expect this extra event to load mcard)
+    PostAsyncEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO, port);
+
+    v0 = 1; pc0 = ra;
+}
+
+void psxBios__card_auto(HLE_BIOS_CALL_ARGS) { // 0xAD
+    PSXBIOS_LOG("psxBios_%s", biosA0n[0xAD]);
+
+    pc0 = ra;
+}
+
+/* System calls B0 */
+
+void psxBios_SysMalloc(HLE_BIOS_CALL_ARGS) { // 00
+    // Allocation shall happen only once at init
+    // so let's not bother to support free
+    // Add a check if the continuous allocator is failling
+    rel_check(g_hle->kheap_size > a0);
     uint32_t aligned_size = (a0 + 3) & ~0x3;
 
     v0 = g_hle->kheap_addr | PS1_KernelSegment;
@@ -2175,6 +2922,28 @@ void psxBios_open(HLE_BIOS_CALL_ARGS) { // 0x32
         if (!strncmp(pa0, "bu10", 4)) {
             buopen(2);
         }
+
+        if (psxFs_IsHostPath(pa0)) {
+            for (u32 fd = kHostFirstFd; fd < kHostLastFd; fd++) {
+                auto& desc = g_hle->FDesc[fd];
+                if (desc.name[0]) continue;
+                if (HostOpen(desc, pa0)) {
+                    v0 = fd;
+                }
+                break;
+            }
+        }
+
+        if (!strncmp(pa0, "cdrom", 5)) {
+            for (u32 fd = kCdFirstFd; fd < kCdLastFd; fd++) {
+                auto& desc = g_hle->FDesc[fd];
+                if (desc.name[0]) continue;
+                if (CdOpen(desc, pa0)) {
+                    v0 = fd;
+                }
+                break;
+            }
+        }
     }
 
     pc0 = ra;
@@ -2218,6 +2987,14 @@ void psxBios_read(HLE_BIOS_CALL_ARGS) { // 0x34
         switch (a0) {
             case 2: buread(pa1, 1, a2); break;
             case 3: buread(pa1, 2, a2); break;
+            default:
+                if (a0 >= kCdFirstFd && a0 < kCdLastFd && g_hle->FDesc[a0].name[0]) {
+                    v0 = CdRead(g_hle->FDesc[a0], a1, a2);
+                }
+                if (a0 >= kHostFirstFd && a0 < kHostLastFd && g_hle->FDesc[a0].name[0]) {
+                    v0 = HostRead(g_hle->FDesc[a0], a1, a2);
+                }
+                break;
         }
     }
 
@@ -2265,6 +3042,14 @@ void psxBios_write(HLE_BIOS_CALL_ARGS) { // 0x35/0x03
 void psxBios_close(HLE_BIOS_CALL_ARGS) { // 0x36
     PSXBIOS_LOG("psxBios_%s: %x", biosB0n[0x36], a0);
 
+    if (a0 >= kCdFirstFd && a0 < kCdLastFd) {
+        g_hle->FDesc[a0].name[0] = 0;
+    }
+    if (a0 >= kHostFirstFd && a0 < kHostLastFd && g_hle->FDesc[a0].name[0]) {
+        psxFs_HostClose((int)g_hle->FDesc[a0].mcfile);
+        g_hle->FDesc[a0].name[0] = 0;
+    }
+
     v0 = a0;
     pc0 = ra;
 }
@@ -2328,6 +3113,24 @@ static void bufile(int mcd_port, u32 _dir) {
  */
 
 void psxBios_firstfile(HLE_BIOS_CALL_ARGS) { // 42
+#if HLE_ENABLE_YIELD
+    struct {
+        u32 port;
+        u32 spec;
+        u32 dir;
+    } frame;
+
+    if (HleGetYieldState(huid) == 1) {
+        // Resume after the delivery of EVENT_CLASS_CARD_HW
+        HleYieldPop(frame);
+        PostAsyncEvent(EVENT_CLASS_CARD_BIOS, frame.spec, frame.port - 1);
+        v0 = 0;
+        bufile(frame.port, frame.dir);
+        pc0 = ra;
+        return;
+    }
+#endif
+
     auto *pa0 = Ra0;
 
     PSXBIOS_LOG("psxBios_%s: %s", biosB0n[0x42], Ra0);
@@ -2340,18 +3143,30 @@ void psxBios_firstfile(HLE_BIOS_CALL_ARGS) { // 42
         // firstfile() calls _card_read() internally, so deliver it's event
         // API seems to be synchronous (firstfile won't return before the delivery of the event)
         // Persona triggers a callback on EVENT_CLASS_CARD_BIOS
+        int port = 0;
         if (!strncmp(pa0, "bu00", 4)) {
-            auto spec = VmcEnabled(0) ? EVENT_SPEC_END_IO : EVENT_SPEC_TIMEOUT;
-
-            DeliverEvent(EVENT_CLASS_CARD_HW, spec);
-            PostAsyncEvent(EVENT_CLASS_CARD_BIOS, spec, 0);
-            bufile(1, a1);
+            port = 1;
         } else if (!strncmp(pa0, "bu10", 4)) {
-            auto spec = VmcEnabled(1) ? EVENT_SPEC_END_IO : EVENT_SPEC_TIMEOUT;
+            port = 2;
+        }
+
+        if (!strncmp(pa0, "cdrom", 5) || psxFs_IsHostPath(pa0)) {
+            v0 = DevNextFile(a1) ? a1 : 0;
+        }
+
+        if (port) {
+            auto spec = VmcEnabled(port - 1) ? EVENT_SPEC_END_IO : EVENT_SPEC_TIMEOUT;
 
+#if HLE_ENABLE_YIELD
+            frame = { (u32)port, (u32)spec, a1 };
+            HleYieldPush(HleMakeYieldUid(0xB0, 0x42, 1), frame);
+            DeliverEvent(EVENT_CLASS_CARD_HW, spec);
+            return;
+#else
             DeliverEvent(EVENT_CLASS_CARD_HW, spec);
-            PostAsyncEvent(EVENT_CLASS_CARD_BIOS, spec, 1);
-            bufile(2, a1);
+            PostAsyncEvent(EVENT_CLASS_CARD_BIOS, spec, port - 1);
+            bufile(port, a1);
+#endif
         }
     }
 
@@ -2377,6 +3192,10 @@ void psxBios_nextfile(HLE_BIOS_CALL_ARGS) { // 43
         bufile(2, a0);
     }
 
+    if (!strncmp(g_hle->ffile, "cdrom", 5) || psxFs_IsHostPath(g_hle->ffile)) {
+        v0 = DevNextFile(a0) ? a0 : 0;
+    }
+
     pc0 = ra;
 }
 
@@ -2456,23 +3275,51 @@ static void budelete(int mcd) {
  */
 
 void psxBios_delete(HLE_BIOS_CALL_ARGS) { // 45
-    char *pa0 = Ra0;
-
-    PSXBIOS_LOG("psxBios_%s: %s", biosB0n[0x45], Ra0);
-
-    v0 = 0;
+#if HLE_ENABLE_YIELD
+    struct {
+        u32 port;
+        u32 name;
+    } frame;
+
+    if (HleGetYieldState(huid) == 1) {
+        // Resume after the delivery of EVENT_CLASS_CARD_HW. budelete reads the name from $a0
+        HleYieldPop(frame);
+        a0 = frame.name;
+        v0 = 0;
+        budelete(frame.port);
+        pc0 = ra;
+        return;
+    }
+#endif
+
+    char *pa0 = Ra0;
+
+    PSXBIOS_LOG("psxBios_%s: %s", biosB0n[0x45], Ra0);
+
+    v0 = 0;
 
     if (pa0) {
         // Game (Azure Dreams)
         // delete() calls _card_read() internally, so deliver it's event
         // API seems to be synchronous (delete won't return before the delivery of the event)
+        int port = 0;
         if (!strncmp(pa0, "bu00", 4)) {
-            DeliverEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO);
-            budelete(1);
+            port = 1;
         }
         if (!strncmp(pa0, "bu10", 4)) {
+            port = 2;
+        }
+
+        if (port) {
+#if HLE_ENABLE_YIELD
+            frame = { (u32)port, a0 };
+            HleYieldPush(HleMakeYieldUid(0xB0, 0x45, 1), frame);
             DeliverEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO);
-            budelete(2);
+            return;
+#else
+            DeliverEvent(EVENT_CLASS_CARD_HW, EVENT_SPEC_END_IO);
+            budelete(port);
+#endif
         }
     }
 
@@ -2707,6 +3554,8 @@ void psxBios_SysEnqIntRP(HLE_BIOS_CALL_ARGS) { // 02
     // Link new element to previous head
     StoreToLE(psxMu32ref(a1), head);
 
+    IrqChainRebuild();
+
     v0 = 0;
     pc0 = ra;
 }
@@ -2751,6 +3600,8 @@ void psxBios_SysDeqIntRP(HLE_BIOS_CALL_ARGS) { // 03
         }
     }
 
+    IrqChainRebuild();
+
     v0 = 0;
     pc0 = ra;
 }
@@ -2905,6 +3756,8 @@ static void initHandlers(u32 kernel_handler) {
     StoreToLE(psxMu32ref(G_HANDLERS_SIZE), SIZEOF_HANDLER * HANDLER_MAX);
     // Fill the IRQ handlers info with 0
     memset(PSXM(kernel_handler), 0, SIZEOF_HANDLER * HANDLER_MAX);
+
+    IrqChainInvalidate();
 }
 
 void psxBiosInitKernelDataStructure() {
@@ -2949,7 +3802,21 @@ void psxBiosInitKernelDataStructure() {
     pc0 = old_pc;
 }
 
+#if HLE_ENABLE_YIELD
+static void hleKernel_Exception(HLE_BIOS_CALL_ARGS);
+static void hleKernel_Syscall(HLE_BIOS_CALL_ARGS);
+static void hleKernel_Interrupt(HLE_BIOS_CALL_ARGS);
+#endif
+
 void psxBiosInit_Lib() {
+#if HLE_ENABLE_YIELD
+    // Resume points of the kernel internal routines
+    biosKernel[HLE_KCALL_Exception] = hleKernel_Exception;
+    biosKernel[HLE_KCALL_Syscall]   = hleKernel_Syscall;
+    biosKernel[HLE_KCALL_Interrupt] = hleKernel_Interrupt;
+#endif
+    initEventsYield();
+
     //biosA0[0x40] = psxBios_sys_a0_40;
     //biosA0[0x41] = psxBios_LoadTest;
 
@@ -2984,12 +3851,12 @@ void psxBiosInit_Lib() {
     //biosA0[0x5c] = psxBios_dev_tty_open;
     //biosA0[0x5d] = psxBios_sys_a0_5d;
     //biosA0[0x5e] = psxBios_dev_tty_ioctl;
-    //biosA0[0x5f] = psxBios_dev_cd_open;
-    //biosA0[0x60] = psxBios_dev_cd_read;
-    //biosA0[0x61] = psxBios_dev_cd_close;
-    //biosA0[0x62] = psxBios_dev_cd_firstfile;
-    //biosA0[0x63] = psxBios_dev_cd_nextfile;
-    //biosA0[0x64] = psxBios_dev_cd_chdir;
+    biosA0[0x5f] = psxBios_dev_cd_open;
+    biosA0[0x60] = psxBios_dev_cd_read;
+    biosA0[0x61] = psxBios_dev_cd_close;
+    biosA0[0x62] = psxBios_dev_cd_firstfile;
+    biosA0[0x63] = psxBios_dev_cd_nextfile;
+    biosA0[0x64] = psxBios_dev_cd_chdir;
     //biosA0[0x65] = psxBios_dev_card_open;
     //biosA0[0x66] = psxBios_dev_card_read;
     //biosA0[0x67] = psxBios_dev_card_write;
@@ -3007,20 +3874,20 @@ void psxBiosInit_Lib() {
     //biosA0[0x75] = psxBios_sys_a0_75;
     //biosA0[0x76] = psxBios_sys_a0_76;
     //biosA0[0x77] = psxBios_sys_a0_77;
-    //biosA0[0x78] = psxBios__96_CdSeekL;
+    biosA0[0x78] = psxBios__96_CdSeekL;
     //biosA0[0x79] = psxBios_sys_a0_79;
     //biosA0[0x7a] = psxBios_sys_a0_7a;
     //biosA0[0x7b] = psxBios_sys_a0_7b;
-    //biosA0[0x7c] = psxBios__96_CdGetStatus;
+    biosA0[0x7c] = psxBios__96_CdGetStatus;
     //biosA0[0x7d] = psxBios_sys_a0_7d;
-    //biosA0[0x7e] = psxBios__96_CdRead;
+    biosA0[0x7e] = psxBios__96_CdRead;
     //biosA0[0x7f] = psxBios_sys_a0_7f;
     //biosA0[0x80] = psxBios_sys_a0_80;
     //biosA0[0x81] = psxBios_sys_a0_81;
     //biosA0[0x82] = psxBios_sys_a0_82;
     //biosA0[0x83] = psxBios_sys_a0_83;
     //biosA0[0x84] = psxBios_sys_a0_84;
-    //biosA0[0x85] = psxBios__96_CdStop;
+    biosA0[0x85] = psxBios__96_CdStop;
     //biosA0[0x86] = psxBios_sys_a0_86;
     //biosA0[0x87] = psxBios_sys_a0_87;
     //biosA0[0x88] = psxBios_sys_a0_88;
@@ -3054,7 +3921,7 @@ void psxBiosInit_Lib() {
     //biosA0[0xa2] = psxBios_EnqueueCdIntr;
     //biosA0[0xa3] = psxBios_DequeueCdIntr;
     //biosA0[0xa4] = psxBios_sys_a0_a4;
-    //biosA0[0xa5] = psxBios_ReadSector;
+    biosA0[0xa5] = psxBios_ReadSector;
     biosA0[0xa6] = psxBios_get_cd_status;
     //biosA0[0xa7] = psxBios_bufs_cb_0;
     //biosA0[0xa8] = psxBios_bufs_cb_1;
@@ -3214,8 +4081,192 @@ void psxBiosInit_Lib() {
     //biosC0[0x1c] = psxBios_PatchAOTable;
 }
 
+// Startup profile
+//
+// Each phase of the init and of the boot is timed, along with the disc bytes it read. The disc index is walked
+// in the background: its own timings are reported apart, its reads are accounted to the phases they overlap.
+
+static std::vector<HleStartupPhase> s_startup_phases;
+
+struct StartupPhaseTimer {
+    using Clock = std::chrono::steady_clock;
+
+    const char*         name;
+    Clock::time_point   start    = Clock::now();
+    uint64_t            io_start = psxFs_GetMediaBytesRead();
+
+    StartupPhaseTimer(const char* name) : name(name) {}
+    ~StartupPhaseTimer() { Stop(); }
+
+    void Stop() {
+        if (!name) return;
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        s_startup_phases.push_back({ name, (uint64_t)us, psxFs_GetMediaBytesRead() - io_start });
+        name = nullptr;
+    }
+};
+
+extern "C" int HleGetStartupReport(HleStartupPhase* dest, int max) {
+    auto report = s_startup_phases;
+
+    uint64_t parse_us, lut_us, io_bytes;
+    psxFs_GetIndexTimings(parse_us, lut_us, io_bytes);
+    report.push_back({ "fs/index_parse", parse_us, io_bytes });
+    report.push_back({ "fs/index_lut",   lut_us,   0        });
+
+    for (int i = 0; dest && i < max && i < (int)report.size(); ++i) {
+        dest[i] = report[i];
+    }
+    return (int)report.size();
+}
+
+extern "C" void HlePrintStartupReport() {
+    HleStartupPhase phases[64];
+    int count = std::min(HleGetStartupReport(phases, 64), 64);
+
+    uint64_t total_us = 0;
+    std::string json = "{\"phases\":[";
+    for (int i = 0; i < count; ++i) {
+        char item[128];
+        snprintf(item, sizeof(item), "%s{\"name\":\"%s\",\"wall_us\":%llu,\"io_bytes\":%llu}", i ? "," : "",
+            phases[i].name, (unsigned long long)phases[i].wall_us, (unsigned long long)phases[i].io_bytes);
+        json += item;
+        // the index timings overlap the init/boot phases
+        if (strncmp(phases[i].name, "fs/", 3) != 0) total_us += phases[i].wall_us;
+    }
+    json += "],\"total_us\":" + std::to_string(total_us) + "}";
+    SysPrintf("(hlebios) startup: %s\n", json.c_str());
+}
+
+// Kernel image
+//
+// The low RAM words set up by every init (vector table fixups, trap opcodes, garbage area, game hacks and
+// exception trampoline), stored in this order: the last store to an address wins (TABLE_C0 entry 6).
+
+struct KernelWord {
+    uint32_t addr;
+    uint32_t value;
+};
+
+// Wonderful hack for Metal Gears Solid
+// The game query the function pointer of table A0/0x9D (GetConf)
+// With the opcode they compute the address of the global conf structure
+// Then manually update the parameters
+//
+// We don't care about those values but we care that game doesn't write random
+// stuff at random address... So let's do black magic
+//
+// Redirect 0x9D to a free memory
+static constexpr u32 kPseudoGetConf = KERNEL_END - 32;
+
+// Another hack for The king of fighter. This one is very funny, they patch
+// the exception handler with a trampoline to likely fix a bug in the kernel
+// 3c02a001 lui v0, a001
+// 2442dfac addiu v0, v0, dfac
+// 00400008 jr v0
+// 00000000 nop
+// 00000000 nop
+// Meanwhile due to a nullptr they write the GPU DMA linked list into 0x-0x30 range address
+// Due to nullptr in the C0 vector in HLE, the game patch ends up killing the DMA linked list
+static constexpr u32 kPseudoExceptionHandler = kPseudoGetConf - 128;
+
+static constexpr KernelWord kKernelImage[] = {
+    // I'm not quite sure what this is about ... it's setting up some values into B0/C0 table, so I assume
+    // it should only be performed when bypassing BIOS entirely --jstine
+    { TABLE_B0,         0x4c54 - 0x884 },
+    { TABLE_C0 + 6 * 4, 0xc80 },
+
+    { 0x0150, 0x160 },
+    { 0x0154, 0x320 },
+    { 0x0160, 0x248 },
+/*  { 0x0ca8, 0x1f410004 },
+    { 0x0cf0, 0x3c020000 },
+    { 0x0cf4, 0x2442641c },
+    { 0x09e0, 0x43d0 },
+    { 0x4d98, 0x946f000a },
+*/
+    // opcode HLE
+    /* Whatever this does, it actually breaks CTR, even without the uninitiliazed memory patch.
+    Normally games shouldn't read from address 0 yet they do. See explanation below in details. */
+    //{ 0x0000, (0x3bu << 26) | 0 },
+    { 0x00a0, (0x3bu << 26) | 1 },
+    { 0x00b0, (0x3bu << 26) | 2 },
+    { 0x00c0, (0x3bu << 26) | 3 },
+    { 0x4c54, (0x3bu << 26) | 0 },
+    { 0x8000, (0x3bu << 26) | 5 },
+    { 0x07a0, (0x3bu << 26) | 0 },
+    { 0x0884, (0x3bu << 26) | 0 },
+    { 0x0894, (0x3bu << 26) | 0 },
+
+    // initial stack pointer for BIOS interrupt
+    { 0x6c80, 0x000085c8 },
+
+    // initial RNG seed
+    { 0x9010, 0xac20cc00 },
+
+    /*	Some games like R-Types, CTR, Fade to Black read from adress 0x00000000 due to uninitialized pointers.
+        See Garbage Area at Address 00000000h in Nocash PSX Specfications for more information.
+        Here are some examples of games not working with this fix in place :
+        R-type won't get past the Irem logo if not implemented.
+        Crash Team Racing will softlock after the Sony logo.
+    */
+    { 0x0000, 0x00000003 },
+    /*
+    But overwritten by 00000003h after soon.
+    { 0x0000, 0x00001A3C },
+    */
+    { 0x0004, 0x800C5A27 },
+    { 0x0008, 0x08000403 },
+    { 0x000C, 0x00000000 },
+
+    // MGS: 2 dummy opcode that will be used to build an address (KERNEL_HEAP + 4)
+    { TABLE_A0 + 0x9D * 4,          kPseudoGetConf },
+    { kPseudoGetConf,               0xA001 },
+    { kPseudoGetConf + 4,           kPseudoGetConf + 16 },
+
+    // KOF
+    { TABLE_C0 + 6 * 4,             kPseudoExceptionHandler },
+    { kPseudoExceptionHandler + 116, kPseudoExceptionHandler },
+
+    // Install a trampoline for exception handler
+    //
+    // Note: Jackie Chan replaces the trampoline to call their own exception handler. But they
+    // still call a copy of the kernel trampoline
+    { KERNEL_EXCEPTION_VECTOR +  0, 0x3c1a'0000 },                              // lui k0, 0
+    { KERNEL_EXCEPTION_VECTOR +  4, 0x375a'0000 + KERNEL_EXCEPTION_HANDLER },   // ori k0, k0, immediate
+    { KERNEL_EXCEPTION_VECTOR +  8, 0x0340'0008 },                              // jr k0
+    { KERNEL_EXCEPTION_VECTOR + 12, 0x0000'0000 },                              // nop
+};
+
+#if HAS_ZLIB
+// The SJIS fonts are only decompressed by the first init, the following ones copy the decompressed data.
+static std::vector<uint8_t> s_font_8140;
+static std::vector<uint8_t> s_font_889f;
+
+static void CopyFontImage() {
+    auto* rom_8140 = (uint8_t*)PSX_ROM_START + ROM_FONT_8140;
+    auto* rom_889f = (uint8_t*)PSX_ROM_START + ROM_FONT_889F;
+    if (s_font_8140.empty()) {
+        uLongf len;
+        len = 0x80000 - 0x66000;
+        uncompress((Bytef *)rom_8140, &len, font_8140, sizeof(font_8140));
+        s_font_8140.assign(rom_8140, rom_8140 + len);
+        len = 0x80000 - 0x69d68;
+        uncompress((Bytef *)rom_889f, &len, font_889f, sizeof(font_889f));
+        s_font_889f.assign(rom_889f, rom_889f + len);
+        return;
+    }
+    memcpy(rom_8140, s_font_8140.data(), s_font_8140.size());
+    memcpy(rom_889f, s_font_889f.data(), s_font_889f.size());
+}
+#endif
+
+static void PadInvalidateCache();
+
 void psxBiosInitFull() {
+    s_startup_phases.clear();
 
+    StartupPhaseTimer tables("init/tables");
     psxBiosInit_StdLib();
     psxBiosInit_Lib();
 
@@ -3224,13 +4275,24 @@ void psxBiosInitFull() {
 
     // Default init most field to 0
     memset(g_hle, 0, sizeof(HleState));
+    psxFs_HostCloseAll();
 
     g_hle->version = 2;
     g_hle->cardState = ~0;
 
-    psxBiosInitKernelDataStructure();
+    PadInvalidateCache();
+    tables.Stop();
 
+    // starts the disc directory walk in the background, overlapped with the rest of the init
+    StartupPhaseTimer fs_index("init/fs_index");
     psxFs_CacheFilesystem();
+    fs_index.Stop();
+
+    StartupPhaseTimer kernel_data("init/kernel_data");
+    psxBiosInitKernelDataStructure();
+    kernel_data.Stop();
+
+    StartupPhaseTimer patches("init/patches");
 
     // Set a magic value in the exception vector to detect if the savestate is from this
     // HLE bios or something else
@@ -3242,123 +4304,41 @@ void psxBiosInitFull() {
     biosA0[0x71] = psxBios__96_init;
     biosA0[0x72] = psxBios__96_remove;
 
-    // I'm not quite sure what this is about ... it's setting up some values into B0/C0 table, so I assume
-    // it should only be performed when bypassing BIOS entirely --jstine
-
-    auto* ptr = (u32 *)PSXM(TABLE_B0);
-    StoreToLE(ptr[0], 0x4c54 - 0x884);
+    strcpy((char *)PSXM(0x248), "bu");
 
-    ptr = (u32 *)PSXM(TABLE_C0);
-    StoreToLE(ptr[6], 0xc80);
+    // The whole image is stored here, ahead of the fonts and of the hardware setup below (including the
+    // exception trampoline that used to be installed last): none of them touch these words.
+    for (auto& word : kKernelImage) {
+        StoreToLE(psxMu32ref(word.addr), word.value);
+    }
 
-    StoreToLE(psxMu32ref(0x0150), 0x160);
-    StoreToLE(psxMu32ref(0x0154), 0x320);
-    StoreToLE(psxMu32ref(0x0160), 0x248);
-    strcpy((char *)PSXM(0x248), "bu");
-/*	StoreToLE(psxMu32ref(0x0ca8), 0x1f410004);
-    StoreToLE(psxMu32ref(0x0cf0), 0x3c020000);
-    StoreToLE(psxMu32ref(0x0cf4), 0x2442641c);
-    StoreToLE(psxMu32ref(0x09e0), 0x43d0);
-    StoreToLE(psxMu32ref(0x4d98), 0x946f000a);
-*/
     // opcode HLE
     (u32&)PSX_ROM_START[0x0000] = LoadFromLE<u32>((0x3b << 26) | 4);
-    /* Whatever this does, it actually breaks CTR, even without the uninitiliazed memory patch.
-    Normally games shouldn't read from address 0 yet they do. See explanation below in details. */
-    //StoreToLE(psxMu32ref(0x0000), (0x3b << 26) | 0);
-    StoreToLE(psxMu32ref(0x00a0), (0x3b << 26) | 1);
-    StoreToLE(psxMu32ref(0x00b0), (0x3b << 26) | 2);
-    StoreToLE(psxMu32ref(0x00c0), (0x3b << 26) | 3);
-    StoreToLE(psxMu32ref(0x4c54), (0x3b << 26) | 0);
-    StoreToLE(psxMu32ref(0x8000), (0x3b << 26) | 5);
-    StoreToLE(psxMu32ref(0x07a0), (0x3b << 26) | 0);
-    StoreToLE(psxMu32ref(0x0884), (0x3b << 26) | 0);
-    StoreToLE(psxMu32ref(0x0894), (0x3b << 26) | 0);
 
-    // initial stack pointer for BIOS interrupt
-    StoreToLE(psxMu32ref(0x6c80), 0x000085c8);
+    // I don't know why but the "devil dice" copies the rom from 0 up to this
+    // magical value. In order to avoid an infinite loop, let's put this
+    // magical value in the middle of the rom
+    StoreToLE((u32&)PSX_ROM_START[ROM_DEVIL_DICE_MAGIC], 0x03E0'0008);
 
-    // initial RNG seed
-    StoreToLE(psxMu32ref(0x9010), 0xac20cc00);
+    patches.Stop();
 
 #if HAS_ZLIB
-    // fonts
-    uLongf len;
-    len = 0x80000 - 0x66000;
-    uncompress((Bytef *)(PSX_ROM_START + ROM_FONT_8140), &len, font_8140, sizeof(font_8140));
-    len = 0x80000 - 0x69d68;
-    uncompress((Bytef *)(PSX_ROM_START + ROM_FONT_889F), &len, font_889f, sizeof(font_889f));
+    StartupPhaseTimer fonts("init/fonts");
+    CopyFontImage();
+    fonts.Stop();
 #endif
 
+    StartupPhaseTimer hw("init/hw");
+
     // memory size 2 MB
     // (mednafen doesn't seem to bother to set this...)
     Write_MEMCTRL2(0x00000b88);
 
-
-    /*	Some games like R-Types, CTR, Fade to Black read from adress 0x00000000 due to uninitialized pointers.
-        See Garbage Area at Address 00000000h in Nocash PSX Specfications for more information.
-        Here are some examples of games not working with this fix in place :
-        R-type won't get past the Irem logo if not implemented.
-        Crash Team Racing will softlock after the Sony logo.
-    */
-
-    StoreToLE(psxMu32ref(0x0000),0x00000003);
-    /*
-    But overwritten by 00000003h after soon.
-    StoreToLE(psxMu32ref(0x0000), 0x00001A3C);
-    */
-    StoreToLE(psxMu32ref(0x0004), 0x800C5A27);
-    StoreToLE(psxMu32ref(0x0008), 0x08000403);
-    StoreToLE(psxMu32ref(0x000C), 0x00000000);
-
-
-    // Wonderful hack for Metal Gears Solid
-    // The game query the function pointer of table A0/0x9D (GetConf)
-    // With the opcode they compute the address of the global conf structure
-    // Then manually update the parameters
-    //
-    // We don't care about those values but we care that game doesn't write random
-    // stuff at random address... So let's do black magic
-    //
-    // Redirect 0x9D to a free memory
-    u32 pseudo_getconf = KERNEL_END - 32;
-    StoreToLE(psxMu32ref(TABLE_A0 + 0x9D * 4), pseudo_getconf);
-    // Store 2 dummy opcode that will be used to build an address (KERNEL_HEAP + 4)
-    StoreToLE(psxMu32ref(pseudo_getconf), 0xA001);
-    StoreToLE(psxMu32ref(pseudo_getconf+4), pseudo_getconf + 16);
-
-    // Another hack for The king of fighter. This one is very funny, they patch
-    // the exception handler with a trampoline to likely fix a bug in the kernel
-    // 3c02a001 lui v0, a001
-    // 2442dfac addiu v0, v0, dfac
-    // 00400008 jr v0
-    // 00000000 nop
-    // 00000000 nop
-    // Meanwhile due to a nullptr they write the GPU DMA linked list into 0x-0x30 range address
-    // Due to nullptr in the C0 vector in HLE, the game patch ends up killing the DMA linked list
-    u32 pseudo_ExceptionHandler = pseudo_getconf - 128;
-    StoreToLE(psxMu32ref(TABLE_C0 + 6 * 4), pseudo_ExceptionHandler);
-    StoreToLE(psxMu32ref(pseudo_ExceptionHandler + 116), pseudo_ExceptionHandler);
-
     // Init timer related variable
     init_timers();
 
     // Reset GPU stat, in particular enable the display
     GPU_W_STATUS(0x0300'0000);
-
-    // Install a trampoline for exception handler
-    //
-    // Note: Jackie Chan replaces the trampoline to call their own exception handler. But they
-    // still call a copy of the kernel trampoline
-    StoreToLE(psxMu32ref(KERNEL_EXCEPTION_VECTOR +  0), 0x3c1a'0000);                            // lui k0, 0
-    StoreToLE(psxMu32ref(KERNEL_EXCEPTION_VECTOR +  4), 0x375a'0000 + KERNEL_EXCEPTION_HANDLER); // ori k0, k0, immediate
-    StoreToLE(psxMu32ref(KERNEL_EXCEPTION_VECTOR +  8), 0x0340'0008);                            // jr k0
-    StoreToLE(psxMu32ref(KERNEL_EXCEPTION_VECTOR + 12), 0x0000'0000);                            // nop
-
-    // I don't know why but the "devil dice" copies the rom from 0 up to this
-    // magical value. In order to avoid an infinite loop, let's put this
-    // magical value in the middle of the rom
-    StoreToLE((u32&)PSX_ROM_START[ROM_DEVIL_DICE_MAGIC], 0x03E0'0008);
 }
 
 void psxBiosShutdown() {
@@ -3413,13 +4393,15 @@ static std::string exe_to_game_code(std::string code) {
     return code;
 }
 
-void psxBiosLoadExecCdrom() {
-    psxFs_CacheFilesystem();
+static void biosParseSystemCnf(PSX_BOOT_INFO& info) {
+    info = {};
 
-    std::string exepath;
     if (auto sector = psxFs_GetFileSector("/SYSTEM.CNF;1")) {
-        uint8_t buf[2048];
+        info.has_cnf = 1;
+
+        uint8_t buf[2049];
         psxFs_ReadSectorData2048(buf, sector);
+        buf[2048] = 0;
         auto alltok = Tokenizer((char*)buf);
         while (auto line = alltok.GetNextToken("\r\n")) {
             auto linetok = Tokenizer(line);
@@ -3430,7 +4412,7 @@ void psxBiosLoadExecCdrom() {
 
                 if (strcasecmp(lvalue, "boot") == 0) {
                     if (rvalue) {
-                        exepath = rvalue;
+                        snprintf(info.boot, sizeof(info.boot), "%s", rvalue);
                     }
                     else {
                         SysErrorPrintf("SYSTEM.CNF: BOOT lvalue does not have a valid rvalue.\n");
@@ -3442,23 +4424,57 @@ void psxBiosLoadExecCdrom() {
                 }
                 if (strcasecmp(lvalue, "tcb") == 0) {
                     if (rvalue) {
-                        TCB_MAX = strtol(rvalue, nullptr, 16);
+                        info.has_tcb = 1;
+                        info.tcb = strtol(rvalue, nullptr, 16);
                     }
                 }
                 if (strcasecmp(lvalue, "event") == 0) {
                     if (rvalue) {
-                        EVCB_MAX = strtol(rvalue, nullptr, 16);
+                        info.has_event = 1;
+                        info.event = strtol(rvalue, nullptr, 16);
                     }
                 }
             }
         }
     }
-    else {
+
+    // Could be useful for per game hack
+    snprintf(info.game_code, sizeof(info.game_code), "%s", exe_to_game_code(info.boot).c_str());
+}
+
+// Boot executable on the host mount (pcdrv:), overrides the BOOT entry of SYSTEM.CNF
+static std::string s_host_boot_exe;
+
+extern "C" void HleSetHostBootExe(const char* path) {
+    s_host_boot_exe = path ? path : "";
+}
+
+void psxBiosLoadExecCdrom() {
+    StartupPhaseTimer fs_index("boot/fs_index");
+    psxFs_CacheFilesystem();
+    fs_index.Stop();
+
+    // SYSTEM.CNF is cached along with the filesystem index
+    StartupPhaseTimer system_cnf("boot/system_cnf");
+    PSX_BOOT_INFO boot;
+    if (!psxFs_GetBootInfo(boot)) {
+        biosParseSystemCnf(boot);
+        psxFs_SetBootInfo(boot);
+    }
+    system_cnf.Stop();
+
+    if (!boot.has_cnf) {
         SysErrorPrintf("SYSTEM.CNF not found. Falling back on PSX.EXE...\n");
     }
+    if (boot.has_tcb) {
+        TCB_MAX = boot.tcb;
+    }
+    if (boot.has_event) {
+        EVCB_MAX = boot.event;
+    }
 
-    // Could be useful for per game hack
-    std::string game_code = exe_to_game_code(exepath);
+    std::string exepath = boot.boot;
+    std::string game_code = boot.game_code;
 
     if (game_code == "SLES-03221"
         || game_code == "SLES-03222"
@@ -3475,14 +4491,19 @@ void psxBiosLoadExecCdrom() {
         // a nice buffer overrun...
         TCB_MAX += 1;
     }
+    StartupPhaseTimer game_config("boot/game_config");
     set_per_game_config(game_code);
 
     // TCB/Event size can be updated by system;cnf setting
     psxBiosInitKernelDataStructure();
+    game_config.Stop();
 
     if (exepath.empty()) {
         exepath = "cdrom:///PSX.EXE";
     }
+    if (!s_host_boot_exe.empty()) {
+        exepath = s_host_boot_exe;
+    }
 
     // FIXUP all incorrect URI prefixes.
     // Favor triple-slash prefix, since the world of browsers adhere to it.
@@ -3556,63 +4577,202 @@ void psxBiosLoadExecCdrom() {
         post_colon_ptr = exedata;
     }
 
-    if (auto sector = psxFs_GetFileSector(first_nonslash(post_colon_ptr))) {
-        uint8_t buf[2048];
+    auto start_cpu = [](const EXEC_DESCRIPTOR& tdesc) {
+        SetPC(tdesc._pc);
+        gp  = tdesc._gp;
+        sp  = tdesc.s_addr ? tdesc.s_addr : 0x801fff00;
+        g_hle->initial_sp = sp; // For getConf
+
+        SysPrintf("(hlebios) pc0   = %08X\n", pc0);
+        SysPrintf("(hlebios) gp    = %08X\n", gp);
+        SysPrintf("(hlebios) sp    = %08X\n", sp);
+
+        CP0_STATUS &= ~(1ull << 22);	// BEV  (bootstrap)
+        CP0_STATUS |=  (7ull << 28);   // enable COP0,1,2
+        dbg_check((CP0_STATUS & (1<<31)) == 0);
+    };
+
+    StartupPhaseTimer exe_read("boot/exe_read");
+    if (psxFs_IsHostPath(exedata)) {
+        uint8_t hdr[2048];
+        if (HostLoadExecutable(exedata, hdr)) {
+            auto tdesc = ExeDescriptor(hdr);
+            SysPrintf("(hlebios) loaded %s from the host mount\n", exedata);
+            start_cpu(tdesc);
+            exe_read.Stop();
+
+            StartupPhaseTimer cache_flush("boot/cache_flush");
+            psxCpuClear(tdesc.t_addr & 0x1fffffff, tdesc.t_size / 4);
+            PrewarmCode(tdesc);
+        }
+        else {
+            SysErrorPrintf("Failed to load boot executable: %s\n", exedata);
+        }
+    }
+    else if (auto sector = psxFs_GetFileSector(first_nonslash(post_colon_ptr))) {
         //const char id[] = "PS-X EXE";
 
-        psxFs_ReadSectorData2048(buf, sector);
-        EXEC_DESCRIPTOR tdesc = *(EXEC_DESCRIPTOR*)(buf + sizeof(PSX_EXE_HEADER));
+        // The header and the text are read in one go, the text streamed straight into guest RAM. The
+        // layout runs on an async worker: the descriptor is only used once the read is done.
+        EXEC_DESCRIPTOR tdesc;
+        auto text_read = psxFs_SubmitExecutable(sector, [&](const uint8_t* hdr, psxFsSpan* spans, int max_spans) {
+            tdesc = ExeDescriptor(hdr);
+            return GuestRamSpans(tdesc.t_addr, tdesc.t_size, spans, max_spans);
+        });
 
-        for(size_t i=0; i<sizeof(tdesc) / 4; ++i) {
-            auto* val = (int32_t*)&tdesc + i;
-            StoreToLE(*val, *val);
+        if (!psxFs_WaitRead(text_read)) {
+            dbg_abort("ReadSectorData failed!");
+            SysErrorPrintf("Failed to load boot executable: %s\n", exedata);
+            return;
         }
+        exe_read.Stop();
 
         intmax_t text_addr = tdesc.t_addr & 0x1fffffff;
         intmax_t text_size = tdesc.t_size;
-        auto* ramdest = PSXM(text_addr);
-        SysPrintf("(hlebios) reading %jd (%08jX) bytes into addr %08jx (host @ %p)\n", JFMT(text_size), JFMT(text_size), text_addr, ramdest);
-        if (psxFs_ReadSectorData2048(ramdest, sector+1, (text_size + 2047) / 2048) == 0) {
-            dbg_abort("ReadSectorData failed!");
-        }
+        SysPrintf("(hlebios) read %jd (%08jX) bytes into addr %08jx (host @ %p)\n",
+            JFMT(text_size), JFMT(text_size), JFMT(text_addr), PSXM(tdesc.t_addr)
+        );
 
+        start_cpu(tdesc);
+
+        StartupPhaseTimer cache_flush("boot/cache_flush");
         psxCpuClear(text_addr, text_size / 4);
+        PrewarmCode(tdesc);
+        cache_flush.Stop();
 
 #if HLE_MEDNAFEN_IFC
         // DUMP! donotcheckin
         if (0) {
+            auto* ramdest = PSXM(text_addr);
             auto* insnptr = (uint32_t*)ramdest;
             for (int i=0; i<text_size; i+=4) {
                 SysPrintf( "[MIPS] %06jx:%08jx %s\n", JFMT(text_addr) + i, JFMT((uint32_t&)ramdest[i]), DisassembleMIPS(text_addr + i, (uint32_t&)ramdest[i]).c_str());
             }
         }
 #endif
+    }
+    else {
+        SysErrorPrintf("Failed to load boot executable: %s\n", exedata);
+    }
+}
 
-        SetPC(tdesc._pc);
-        gp  = tdesc._gp;
-        sp  = tdesc.s_addr ? tdesc.s_addr : 0x801fff00;
-        g_hle->initial_sp = sp; // For getConf
+// Pad sampling
+//
+// Each port is read with a single block transfer (PAD_transfer_block) per VBlank. The connected state is
+// checked on every VBlank (cheap, so controllers attached later are picked up), only the controller id (which
+// gives the packet size) is cached per port. HlePadHotplug drops the cached id.
 
-        SysPrintf("(hlebios) pc0   = %08X\n", pc0);
-        SysPrintf("(hlebios) gp    = %08X\n", gp);
-        SysPrintf("(hlebios) sp    = %08X\n", sp);
+static const int kPadMaxResponse = 2 + 32; // id, 0x5a, up to 16 halfwords
 
-        CP0_STATUS &= ~(1ull << 22);	// BEV  (bootstrap)
-        CP0_STATUS |=  (7ull << 28);   // enable COP0,1,2
-        dbg_check((CP0_STATUS & (1<<31)) == 0);
+struct PadPortCache {
+    bool valid;
+    bool connected;     // state at the last VBlank
+    u8   id;            // last controller id, 0xff if unknown
+};
+
+static PadPortCache s_pad_cache[2];
+static u8 s_pad_resp[2][kPadMaxResponse];
+HlePadStats g_pad_stats;
+
+// Late latch (optional, see HlePadSetLateLatch)
+//
+// The pad buffers are only marked stale at VBlank. They are filled at the first guest access reported by
+// the emulator read/write watch (HlePadOnWatchHit), or right before the VSync event callback, whichever
+// comes first. The time between sampling and the first guest access is reported for each frame.
+using PadClock = std::chrono::steady_clock;
+
+static bool s_pad_late_latch;
+static bool s_pad_stale;
+static bool s_pad_sampled;          // a sample was taken during the current frame
+static bool s_pad_consumed;         // the guest accessed the current sample
+static PadClock::time_point s_pad_sample_time;
+
+static int PadPacketSize(u8 id) {
+    const u8 hiz = 0xff;
+    if (id == hiz || !(id & 0x0f))
+        return kPadMaxResponse;
+    return 2 + (id & 0x0f) * 2;
+}
+
+static void PadInvalidateCache() {
+    for (auto& c : s_pad_cache) {
+        c.valid = false;
     }
-    else {
-        SysErrorPrintf("Failed to load boot executable: %s\n", exedata);
+    // Buffers in guest memory are whatever the state contains
+    s_pad_stale = false;
+    s_pad_sampled = false;
+}
+
+// Reads a full packet: resp[0] = controller id, resp[1] = 0x5a, resp[2..] = data. Missing bytes are 0xff
+static void PadRead(int port, u8* resp) {
+    const u8 hiz = 0xff;
+    auto& cache = s_pad_cache[port];
+
+    if (!cache.valid) {
+        cache.id = hiz;
+        cache.valid = true;
+    }
+
+    cache.connected = PAD_connected(port);
+    if (!cache.connected) {
+        cache.id = hiz;
+        memset(resp, hiz, kPadMaxResponse);
+        g_pad_stats.skipped_ports++;
+        return;
+    }
+
+    int len = PadPacketSize(cache.id);
+    PAD_transfer_block(port, 0x42, resp, len);
+    g_pad_stats.transfers++;
+
+    if (resp[0] != cache.id) {
+        // Controller changed (analog mode button...), the packet might be longer than expected
+        cache.id = resp[0];
+        if (PadPacketSize(cache.id) > len) {
+            len = PadPacketSize(cache.id);
+            PAD_transfer_block(port, 0x42, resp, len);
+            g_pad_stats.transfers++;
+        }
+    }
+
+    if (len < kPadMaxResponse)
+        memset(resp + len, hiz, kPadMaxResponse - len);
+}
+
+// Legacy PAD_init buffer: buttons of both ports packed in a word
+static void PadFillLegacyBuf(u32* buf) {
+    const u8* resp0 = s_pad_resp[0];
+    const u8* resp1 = s_pad_resp[1];
+
+    if (resp0[0] == 0x23) { // negcon
+        *buf = resp0[2] << 8;
+        *buf |= resp0[3];
+        *buf &= ~((resp0[5] > 0x20) ? 1 << 6 : 0);
+        *buf &= ~((resp0[6] > 0x20) ? 1 << 7 : 0);
+    } else {
+        *buf = resp0[2] << 8;
+        *buf|= resp0[3];
+    }
+
+    if (resp1[0] == 0x23) { // negcon
+        *buf |= resp1[2] << 24;
+        *buf |= resp1[3] << 16;
+        *buf &= ~((resp1[5] > 0x20) ? 1 << 22 : 0);
+        *buf &= ~((resp1[6] > 0x20) ? 1 << 23 : 0);
+    } else {
+        *buf |= resp1[2] << 24;
+        *buf |= resp1[3] << 16;
     }
 }
 
+// InitPAD buffer: connection status, controller id and data
 void psxBios_PADpoll(int pad, u8* buf) {
     const u8 hiz = 0xff;
+    const u8* resp = s_pad_resp[pad];
     int bufcount;
 
-    PAD_startPoll(pad);
-    buf[0] = PAD_connected(pad) ? 0 : hiz;
-    buf[1] = PAD_poll(pad, 0x42);
+    buf[0] = s_pad_cache[pad].connected ? 0 : hiz;
+    buf[1] = resp[0];
     if (buf[1] == hiz) {
         bufcount = 0;
     } else if (!(buf[1] & 0x0f)) {
@@ -3620,24 +4780,174 @@ void psxBios_PADpoll(int pad, u8* buf) {
     } else {
         bufcount = (buf[1] & 0x0f) * 2;
     }
-    PAD_poll(pad, 0);
-    int i = 2;
-    while (bufcount--) {
-        buf[i++] = PAD_poll(pad, 0);
-    }
+    memcpy(buf + 2, resp + 2, bufcount);
 
 #if 0
     PSXBIOS_LOG("psxBios_PADpoll %d:", pad);
-    for (int c = 0; c < i; c++) {
+    for (int c = 0; c < bufcount + 2; c++) {
         printf("%02x ", buf[c]);
     }
     printf("\n");
 #endif
 }
 
-void biosInterrupt() {
-    auto istat = Read_ISTAT() & Read_IMASK();
+static void PadSample() {
+    if (g_hle->pad_buf) {
+        PadRead(0, s_pad_resp[0]);
+        PadRead(1, s_pad_resp[1]);
+        PadFillLegacyBuf((u32*)PSXM(g_hle->pad_buf));
+    }
+
+    if (g_hle->pad_buf1) {
+        if (!g_hle->pad_buf)
+            PadRead(0, s_pad_resp[0]);
+        psxBios_PADpoll(0, PSXM(g_hle->pad_buf1));
+    }
+
+    if (g_hle->pad_buf2) {
+        if (!g_hle->pad_buf)
+            PadRead(1, s_pad_resp[1]);
+        psxBios_PADpoll(1, PSXM(g_hle->pad_buf2));
+    }
+
+    g_pad_stats.samples++;
+}
+
+static void PadLatch() {
+    PadSample();
+
+    s_pad_stale = false;
+    s_pad_sampled = true;
+    s_pad_consumed = false;
+    s_pad_sample_time = PadClock::now();
+}
+
+// Report the latency of the frame that ends
+static void PadEndFrame() {
+    if (!s_pad_sampled)
+        return;
+
+    if (s_pad_consumed) {
+        PSXBIOS_LOG_SPAM("pad latency: %u us", g_pad_stats.latency_last_us);
+    } else {
+        g_pad_stats.frames_unconsumed++;
+        PSXBIOS_LOG_SPAM("pad latency: sample not consumed");
+    }
+    s_pad_sampled = false;
+}
+
+static void PadOnVBlank() {
+    PadEndFrame();
+
+    if (s_pad_late_latch) {
+        s_pad_stale = true;
+    } else {
+        PadLatch();
+    }
+}
+
+// Late latch: the VSync event callback is the last moment to fill the buffers before the game might use them
+static void PadLatchBeforeVSyncCallback(u32 istat) {
+    if (s_pad_stale && (istat & 0x1) && EventHasCallback(EVENT_CLASS_TIMER + 3, EVENT_SPEC_INTERRUPT)) {
+        PadLatch();
+        g_pad_stats.latched_callback++;
+    }
+}
 
+extern "C" void HlePadHotplug(int port) {
+    if ((u32)port < countof(s_pad_cache)) {
+        s_pad_cache[port].valid = false;
+    }
+}
+
+extern "C" void HlePadSetLateLatch(int enable) {
+    s_pad_late_latch = !!enable;
+
+    // Don't leave stale buffers behind
+    if (!s_pad_late_latch && s_pad_stale && g_hle && g_hle->pad_started)
+        PadLatch();
+}
+
+extern "C" int HlePadGetWatchRanges(uint32_t* addrs, uint32_t* sizes, int max) {
+    int count = 0;
+    auto add = [&](u32 addr, u32 size) {
+        if (addr && count < max) {
+            addrs[count] = addr;
+            sizes[count] = size;
+            count++;
+        }
+    };
+
+    if (g_hle && g_hle->pad_started) {
+        add(g_hle->pad_buf, 4);
+        add(g_hle->pad_buf1, kPadMaxResponse);
+        add(g_hle->pad_buf2, kPadMaxResponse);
+    }
+    return count;
+}
+
+extern "C" void HlePadOnWatchHit(uint32_t addr) {
+    if (s_pad_stale) {
+        PadLatch();
+        g_pad_stats.latched_watch++;
+    }
+
+    if (s_pad_sampled && !s_pad_consumed) {
+        s_pad_consumed = true;
+
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(PadClock::now() - s_pad_sample_time).count();
+        g_pad_stats.latency_last_us = (u32)us;
+        g_pad_stats.latency_max_us = std::max(g_pad_stats.latency_max_us, (u32)us);
+        g_pad_stats.latency_sum_us += us;
+        g_pad_stats.frames_consumed++;
+    }
+}
+
+#if HLE_ENABLE_YIELD
+struct InterruptFrame {
+    u32 istat;
+    u32 timer;  // Rcnt 0,1,2 or 3 for VSync
+};
+
+// Delivers the timer events, starting from f.timer (VSync first, then Rcnt 0,1,2)
+static void biosInterruptDeliver(InterruptFrame f) {
+    if (f.timer == 3) {
+        f.timer = 0;
+        if (f.istat & 0x1) { // Vsync
+            HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_Interrupt, 1), f);
+            DeliverEvent(EVENT_CLASS_TIMER + 3, EVENT_SPEC_INTERRUPT);
+            return;
+        }
+    }
+
+    for (; f.timer < 3; f.timer++) { // Rcnt 0,1,2
+        if (f.istat & (1 << (f.timer + 4))) {
+            HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_Interrupt, 2), f);
+            DeliverEvent(EVENT_CLASS_TIMER + f.timer, EVENT_SPEC_INTERRUPT);
+            return;
+        }
+    }
+
+    pc0 = ra;
+}
+
+static void hleKernel_Interrupt(HLE_BIOS_CALL_ARGS) {
+    InterruptFrame f;
+    HleYieldPop(f);
+
+    if (HleGetYieldState(huid) == 2) {
+        // Rcnt event was delivered
+        auto auto_ack = LoadFromLE(psxMu32ref(TIMER_IRQ_AUTO_ACK + (f.timer << 2)));
+        if (auto_ack)
+            Write_ISTAT(~(1 << (f.timer + 4)));
+        f.timer++;
+    }
+
+    biosInterruptDeliver(f);
+}
+#endif
+
+static void biosInterruptPollPads(u32 istat) {
     if (istat & 1) { // Vsync
         // During vsync, bios will access the pad most of the time (see logic below)
         // PAD access is very slow.
@@ -3645,56 +4955,31 @@ void biosInterrupt() {
         AdvanceClock(30 * 1000);
     }
 
-    // Looks like this is polling the pads on every interrupt, which is definitely
-    // not what we want. Will have to dig into it later and see if I can figure out why
-    // someone removed the Vsync condition gate below (likely some hack) --jstine
+    if (!g_hle->pad_started)
+        return;
 
-//	if (istat & 0x1) { // Vsync
-        if (g_hle->pad_started)  {
-            if (g_hle->pad_buf) {
-                u32 *buf = (u32*)PSXM(g_hle->pad_buf);
+    // Pads are sampled once per frame. The VBlank bit is checked in the raw ISTAT (before IMASK), so a game that
+    // masks the VBlank IRQ still gets its pads polled from the other interrupts.
+    if (!(Read_ISTAT() & 0x1)) {
+        g_pad_stats.gated++;
+        return;
+    }
 
-                PAD_startPoll(0);
-                if (PAD_poll(0, 0x42) == 0x23) {
-                    PAD_poll(0, 0);
-                    *buf = PAD_poll(0, 0) << 8;
-                    *buf |= PAD_poll(0, 0);
-                    PAD_poll(0, 0);
-                    *buf &= ~((PAD_poll(0, 0) > 0x20) ? 1 << 6 : 0);
-                    *buf &= ~((PAD_poll(0, 0) > 0x20) ? 1 << 7 : 0);
-                } else {
-                    PAD_poll(0, 0);
-                    *buf = PAD_poll(0, 0) << 8;
-                    *buf|= PAD_poll(0, 0);
-                }
+    PadOnVBlank();
+}
 
-                PAD_startPoll(1);
-                if (PAD_poll(1, 0x42) == 0x23) {
-                    PAD_poll(1, 0);
-                    *buf |= PAD_poll(1, 0) << 24;
-                    *buf |= PAD_poll(1, 0) << 16;
-                    PAD_poll(1, 0);
-                    *buf &= ~((PAD_poll(1, 0) > 0x20) ? 1 << 22 : 0);
-                    *buf &= ~((PAD_poll(1, 0) > 0x20) ? 1 << 23 : 0);
-                } else {
-                    PAD_poll(1, 0);
-                    *buf |= PAD_poll(1, 0) << 24;
-                    *buf |= PAD_poll(1, 0) << 16;
-                }
-            }
+// In yield mode, biosInterrupt is an HLE subroutine: it completes with `pc0 = ra`
+void biosInterrupt() {
+    auto istat = Read_ISTAT() & Read_IMASK();
 
-            if (g_hle->pad_buf1) {
-                psxBios_PADpoll(0, PSXM(g_hle->pad_buf1));
-            }
-
-            if (g_hle->pad_buf2) {
-                psxBios_PADpoll(1, PSXM(g_hle->pad_buf2));
-            }
-        }
-//	}
+    biosInterruptPollPads(istat);
+    PadLatchBeforeVSyncCallback(istat);
 
     // VSYNC and Rcnt 0,1,2 shall be run at priority 1 (actually syscall c0/0x0 set the priority)
 
+#if HLE_ENABLE_YIELD
+    biosInterruptDeliver({ istat, 3 });
+#else
     if (istat & 0x1) { // Vsync
         DeliverEvent(EVENT_CLASS_TIMER + 3, EVENT_SPEC_INTERRUPT);
 #if 0
@@ -3714,6 +4999,57 @@ void biosInterrupt() {
                 Write_ISTAT(~(1 << (i + 4)));
         }
     }
+#endif
+}
+
+// Interrupt fast path
+//
+// Most interrupts (a plain VSync...) don't run any guest code: no async event to deliver, no callback
+// event for the pending timers, no verifier that can fire and no jmp_int. Nothing can observe or switch
+// the thread context in this case, so the TCB save and the interrupt stack are skipped entirely.
+//
+// chain_checked is set once the IRQ chain was validated against guest memory. Having got that far, no guest
+// code can run before the chain walk of the full path (no event callback), which doesn't validate it again.
+static bool biosInterruptNeedsContext(u32 istat, bool& chain_checked) {
+    chain_checked = false;
+    if (g_hle->async_event_nb != 0 || g_hle->async_deliver_nb != 0 || g_hle->jmp_int)
+        return true;
+
+    if ((istat & 0x1) && EventHasCallback(EVENT_CLASS_TIMER + 3, EVENT_SPEC_INTERRUPT))
+        return true;
+
+    for (int i = 0; i < 3; i++) {
+        if ((istat & (1 << (i + 4))) && EventHasCallback(EVENT_CLASS_TIMER + i, EVENT_SPEC_INTERRUPT))
+            return true;
+    }
+
+    // Verifiers read the raw ISTAT
+    chain_checked = true;
+    return IrqChainHasVerifier(Read_ISTAT());
+}
+
+static void biosInterruptFast(u32 istat) {
+    biosInterruptPollPads(istat);
+
+    if (istat & 0x1) { // Vsync
+        DeliverEventNoCallback(EVENT_CLASS_TIMER + 3, EVENT_SPEC_INTERRUPT);
+    }
+
+    for (int i = 0; i < 3; i++) { // Rcnt 0,1,2
+        if (istat & (1 << (i + 4))) {
+            DeliverEventNoCallback(EVENT_CLASS_TIMER + i, EVENT_SPEC_INTERRUPT);
+            auto auto_ack = LoadFromLE(psxMu32ref(TIMER_IRQ_AUTO_ACK + (i <<2)));
+            if (auto_ack)
+                Write_ISTAT(~(1 << (i + 4)));
+        }
+    }
+
+    Write_ISTAT(0);
+
+    pc0 = CP0_EPC;
+    if (CP0_CAUSE & 0x80000000) pc0+=4;
+
+    CP0_RFE();
 }
 
 void psxBiosException180() {
@@ -3757,9 +5093,15 @@ void psxBiosSyscallHandler() {
         default:
             // Jumping flash, sigh...
             // DeliverEvent might fiddle with the TCB content, so you need to restore registers
+#if HLE_ENABLE_YIELD
+            HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_Syscall, 1), nullptr, 0);
+            DeliverEvent(EVENT_CLASS_EXCEPTION, EVENT_SPEC_SYSCALL);
+            return;
+#else
             DeliverEvent(EVENT_CLASS_EXCEPTION, EVENT_SPEC_SYSCALL);
             restoreContextException();
             break;
+#endif
     }
 
     pc0 = CP0_EPC + 4;
@@ -3768,6 +5110,132 @@ void psxBiosSyscallHandler() {
     return;
 }
 
+#if HLE_ENABLE_YIELD
+static void hleKernel_Syscall(HLE_BIOS_CALL_ARGS) {
+    // Resume after the delivery of EVENT_SPEC_SYSCALL. A callback might have raised its own
+    // exception, so rely on the saved context rather than CP0_EPC.
+    HleYieldPop(nullptr, 0);
+    restoreContextException();
+    pc0 += 4;
+    CP0_RFE();
+}
+
+enum ExceptionYieldState : u32 {
+    EXCEPTION_YIELD_ASYNC_EVENT = 1,    // after DeliverAsyncEvent
+    EXCEPTION_YIELD_INTERRUPT,          // after biosInterrupt
+    EXCEPTION_YIELD_VERIFIER,           // after an IRQ verifier
+    EXCEPTION_YIELD_HANDLER,            // after an IRQ handler
+    EXCEPTION_YIELD_ASYNC_EVENT_CHECKED,    // same as above, the IRQ chain was validated on entry
+    EXCEPTION_YIELD_INTERRUPT_CHECKED,
+};
+
+struct IrqChainFrame {
+    IrqChainCursor cursor;
+    u32 handler;
+};
+
+static void biosIrqChainDone() {
+    if (g_hle->jmp_int) {
+        uint32_t* jmpptr = (uint32_t*)PSXM(g_hle->jmp_int);
+        PSXBIOS_LOG_IRQ("jmp_int @ %08x - ra=%08x sp=%08x fp=%08x", g_hle->jmp_int, jmpptr[0], jmpptr[1], jmpptr[2]);
+        Write_ISTAT(0xffffffff);
+
+        ra = jmpptr[0];
+        sp = jmpptr[1];
+        fp = jmpptr[2];
+        for (int i = 0; i < 8; i++) // s0-s7
+             GPR_ARRAY[16 + i] = jmpptr[3 + i];
+        gp = jmpptr[11];
+
+        v0 = 1;
+        pc0 = ra;
+        return;
+    }
+    Write_ISTAT(0);
+
+    // Guest handlers ran on the CPU and clobbered the registers (the current thread may even have been
+    // switched), so return through the saved context like ReturnFromException.
+    u32 pcb = LoadFromLE(psxMu32ref(G_PROCESS));
+    u32 tcb = LoadFromLE(psxMu32ref(pcb));
+    u32 cause = LoadFromLE(((u32*)PSXM(tcb & PS1_SegmentAddrMask))[TCB_CAUSE_IDX]);
+
+    restoreContextException();
+    if (cause & 0x80000000) pc0 += 4;
+
+    CP0_RFE();
+}
+
+// Calls the next verifier of the handler chain
+static void biosIrqChainStep(IrqChainFrame f) {
+    IrqChainEntry e;
+    if (!IrqChainNext(f.cursor, e)) {
+        biosIrqChainDone();
+        return;
+    }
+
+    // Call first the verifier
+    PSXBIOS_LOG_IRQ("\tIRQ verifier %x", e.verifier);
+
+    f.handler = e.handler;
+    HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_Exception, EXCEPTION_YIELD_VERIFIER), f);
+    pc0 = e.verifier;
+}
+
+static void hleKernel_Exception(HLE_BIOS_CALL_ARGS) {
+    switch (HleGetYieldState(huid)) {
+        case EXCEPTION_YIELD_ASYNC_EVENT:
+        case EXCEPTION_YIELD_ASYNC_EVENT_CHECKED: {
+            bool chain_checked = HleGetYieldState(huid) == EXCEPTION_YIELD_ASYNC_EVENT_CHECKED;
+            HleYieldPop(nullptr, 0);
+
+            sp = psxMu32(0x6c80); // create new stack for interrupt handlers
+            HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_Exception,
+                chain_checked ? EXCEPTION_YIELD_INTERRUPT_CHECKED : EXCEPTION_YIELD_INTERRUPT), nullptr, 0);
+            biosInterrupt();
+            break;
+        }
+
+        case EXCEPTION_YIELD_INTERRUPT:
+        case EXCEPTION_YIELD_INTERRUPT_CHECKED: {
+            bool chain_checked = HleGetYieldState(huid) == EXCEPTION_YIELD_INTERRUPT_CHECKED;
+            HleYieldPop(nullptr, 0);
+
+            biosIrqChainStep({ IrqChainBegin(chain_checked), 0 });
+            break;
+        }
+
+        case EXCEPTION_YIELD_VERIFIER: {
+            IrqChainFrame f;
+            HleYieldPop(f);
+
+            // Continue if verifier return 0
+            if (!v0) {
+                biosIrqChainStep(f);
+                break;
+            }
+
+            // Otherwise fire the handler
+            a0 = v0;
+            PSXBIOS_LOG_IRQ("\tIRQ handler %x", f.handler);
+            HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_Exception, EXCEPTION_YIELD_HANDLER), f);
+            pc0 = f.handler;
+            break;
+        }
+
+        case EXCEPTION_YIELD_HANDLER: {
+            IrqChainFrame f;
+            HleYieldPop(f);
+            biosIrqChainStep(f);
+            break;
+        }
+
+        default:
+            dbg_abort();
+            break;
+    }
+}
+#endif
+
 void psxBiosException80() {
     // Special handling for COP2 instruction
     //
@@ -3781,6 +5249,18 @@ void psxBiosException80() {
         CP0_EPC = CP0_EPC + 4;
     }
 
+    auto excode = (CP0_CAUSE & 0x3c) >> 2;
+    bool chain_checked = false;
+    if (excode == 0x00) {
+        auto istat = Read_ISTAT() & Read_IMASK();
+        if (!biosInterruptNeedsContext(istat, chain_checked)) {
+            g_irq_chain_stats.interrupt_fast++;
+            biosInterruptFast(istat);
+            return;
+        }
+        g_irq_chain_stats.interrupt_full++;
+    }
+
     saveContextException();
 
     static const char* const exmne[16] =
@@ -3788,7 +5268,6 @@ void psxBiosException80() {
         "INT", "MOD", "TLBL", "TLBS", "ADEL", "ADES", "IBE", "DBE", "SYSCALL", "BP", "RI", "COPU", "OV", NULL, NULL, NULL
     };
 
-    auto excode = (CP0_CAUSE & 0x3c) >> 2;
     switch (excode) {
         case 0x00: { // Interrupt
             PSXBIOS_LOG_IRQ("interrupt fire");
@@ -3796,43 +5275,32 @@ void psxBiosException80() {
             // Safest place to deliver event. Register context is saved, IRQ are disabled
             // Note: by contruction async event can only be delivered unpon interruption of
             // the main thread otherwise it is synchronous.
+#if HLE_ENABLE_YIELD
+            // The rest of the interrupt is handled by hleKernel_Exception
+            HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_Exception,
+                chain_checked ? EXCEPTION_YIELD_ASYNC_EVENT_CHECKED : EXCEPTION_YIELD_ASYNC_EVENT), nullptr, 0);
+            DeliverAsyncEvent();
+            return;
+#else
             DeliverAsyncEvent();
 
             sp = psxMu32(0x6c80); // create new stack for interrupt handlers
             biosInterrupt();
 
-            u32 handler_ptr = LoadFromLE(psxMu32ref(G_HANDLERS));
-
-            for (u32 i = 0; i < HANDLER_MAX; i++, handler_ptr += SIZEOF_HANDLER) {
-                u32 head = psxMu32ref(handler_ptr);
-                while (head != 0) {
-                    u32 *queue = (u32 *)PSXM(head);
-                    head = queue[0]; // Update linked list pointer
-
-                    u32 handler = queue[1];
-                    u32 verifier = queue[2];
-
-                    // In case someone got the idea to read those register to get info on current handler
-                    s0 = handler;
-                    s1 = verifier;
-
-                    // Call first the verifier
-                    if (!verifier)  continue;
-                    PSXBIOS_LOG_IRQ("\tIRQ verifier %x", verifier);
-                    softCall(verifier);
-
-                    // Continue if verifier return 0
-                    if (!v0) continue;
+            IrqChainCursor cursor = IrqChainBegin(chain_checked);
+            IrqChainEntry e;
+            while (IrqChainNext(cursor, e)) {
+                // Call first the verifier
+                PSXBIOS_LOG_IRQ("\tIRQ verifier %x", e.verifier);
+                softCall(e.verifier);
 
-                    // Otherwise fire the handler
-                    a0 = v0;
-                    PSXBIOS_LOG_IRQ("\tIRQ handler %x", handler);
-                    softCall(handler);
+                // Continue if verifier return 0
+                if (!v0) continue;
 
-                    // FIXME: need to push current queue on the stack.
-                    //assert(false);
-                    //softCallYield(SCRI_biosException_Queue, handler);
-                }
+                // Otherwise fire the handler
+                a0 = v0;
+                PSXBIOS_LOG_IRQ("\tIRQ handler %x", e.handler);
+                softCall(e.handler);
             }
 
             if (g_hle->jmp_int) {
@@ -3853,6 +5321,7 @@ void psxBiosException80() {
             }
             Write_ISTAT(0);
             break;
+#endif
         }
 
         case 0x08: // Syscall
@@ -3903,6 +5372,9 @@ bool psxbios_invoke_any(u32 callTableId, const HLE_BIOS_TABLE& table, const char
     if (table[call]) {
         auto yieldCallId = HleMakeYieldUid(callTableId, call, 0);
         table[call](yieldCallId);
+#if HLE_ENABLE_YIELD
+        HleYieldTrampoline();
+#endif
         return 1;
     }
     else {
@@ -3930,11 +5402,14 @@ static int psxbios_dummy() {
 extern "C" int HleDispatchCall(uint32_t pc) {
 
     if (IsHlePC(pc)) {
-        auto id = HleGetCallId(pc);
-        // TODO: replace this with improved system... (YieldCallId)
+#if HLE_ENABLE_YIELD
+        // Guest code returned to a suspended HLE call
+        HleYieldResume(HleGetCallId(pc));
+        HleYieldTrampoline();
+#else
+        // Only HleExecuteRecursive returns to this address, and it never dispatches it.
         dbg_abort();
-        //dbg_check((u32)id < SCRI_MAX_COUNT);
-        //HLE_Call_Table[id]();
+#endif
         return 1;
     }
 
@@ -3948,6 +5423,9 @@ extern "C" int HleDispatchCall(uint32_t pc) {
             // Old HLE code uses this address to detect a PSX exception
             if (strncmp((char*)PSXM(KERNEL_EXCEPTION_VECTOR), "HLE", 3) == 0) {
                 psxBiosException80();
+#if HLE_ENABLE_YIELD
+                HleYieldTrampoline();
+#endif
                 return 1;
             }
             // fall through
@@ -3959,6 +5437,9 @@ extern "C" int HleDispatchCall(uint32_t pc) {
             return 0;
         case KERNEL_EXCEPTION_HANDLER:
             psxBiosException80();
+#if HLE_ENABLE_YIELD
+            HleYieldTrampoline();
+#endif
             return 1;
         case 0xA0:
             return psxbios_invoke_A0();
@@ -4003,6 +5484,11 @@ void HleHookAfterLoadState(const char* game_code) {
     dbg_check(!(is_hle && is_openbios), "Load state error, can't be HLE and openBios at the same time");
     rel_check(is_hle || is_openbios, "Load state error, must be either HLE or openBios");
 
+    // Host copies of guest data structures don't survive a load state
+    IrqChainInvalidate();
+    PadInvalidateCache();
+    HostInvalidateFiles();
+
     if (is_hle) {
         // State is already HLE-compliant
         // But we still need to patch up thing for newer version
@@ -244,3 +244,40 @@ void psxBiosPrintHandlers() {
         }
     };
 }
+
+void psxBiosPrintIrqChain() {
+    uint32_t count;
+    auto* entries = IrqChainGetEntries(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const auto& e = entries[i];
+        printf("[%d] prio %d node 0x%08x verifier 0x%08x handler 0x%08x", i, e.prio, e.node, e.verifier, e.handler);
+        if (e.noop_known)
+            printf(" (no-op unless ISTAT & 0x%08x)", e.noop_mask);
+        printf("\n");
+    }
+    printf("verifier called: %llu skipped: %llu chain rebuilds: %llu\n",
+        (unsigned long long)g_irq_chain_stats.verifier_called,
+        (unsigned long long)g_irq_chain_stats.verifier_skipped,
+        (unsigned long long)g_irq_chain_stats.rebuilds);
+    printf("interrupts fast path: %llu full path: %llu\n",
+        (unsigned long long)g_irq_chain_stats.interrupt_fast,
+        (unsigned long long)g_irq_chain_stats.interrupt_full);
+}
+
+void psxBiosPrintPadStats() {
+    printf("pad samples: %llu gated interrupts: %llu transfers: %llu skipped ports: %llu\n",
+        (unsigned long long)g_pad_stats.samples,
+        (unsigned long long)g_pad_stats.gated,
+        (unsigned long long)g_pad_stats.transfers,
+        (unsigned long long)g_pad_stats.skipped_ports);
+    printf("late latch: watch %llu callback %llu\n",
+        (unsigned long long)g_pad_stats.latched_watch,
+        (unsigned long long)g_pad_stats.latched_callback);
+    if (g_pad_stats.frames_consumed) {
+        printf("latency: last %u us max %u us avg %llu us (%llu frames, %llu not consumed)\n",
+            g_pad_stats.latency_last_us, g_pad_stats.latency_max_us,
+            (unsigned long long)(g_pad_stats.latency_sum_us / g_pad_stats.frames_consumed),
+            (unsigned long long)g_pad_stats.frames_consumed,
+            (unsigned long long)g_pad_stats.frames_unconsumed);
+    }
+}
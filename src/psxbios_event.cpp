@@ -7,6 +7,10 @@
 // Until code is ready
 #define ASYNC_EVENT 1
 
+#if HLE_ENABLE_YIELD && !ASYNC_EVENT
+#   error "Synchronous PostAsyncEvent can't yield, HLE_ENABLE_YIELD requires ASYNC_EVENT"
+#endif
+
 #if HLE_DUCKSTATION_IFC
 Log_SetChannel(HLEBIOS);
 #endif
@@ -34,6 +38,64 @@ EVCB* GetEVCB() {
     return(EVCB*)PSXM(evcb_addr);
 }
 
+// Delivers (ev, spec) to the EVCB entries starting at `slot`. NO_CALLBACK entries are marked as delivered.
+// Returns the index of the first entry whose callback must be executed, or EVCB_MAX if none remains.
+static u32 DeliverEventScan(u32 ev, u32 spec, u32 slot) {
+    auto evcb = GetEVCB();
+    for (u32 i = slot; i < EVCB_MAX; i++) {
+        if (evcb[i].status == EVENT_STATUS::ENABLED && evcb[i].ev == ev && evcb[i].spec == spec) {
+            if (evcb[i].mode == EVENT_MODE::CALLBACK)
+                return i;
+            evcb[i].status = EVENT_STATUS::DELIVERED;
+        }
+    }
+    return EVCB_MAX;
+}
+
+// True if delivering (ev, spec) would run a guest callback
+bool EventHasCallback(u32 ev, u32 spec) {
+    auto evcb = GetEVCB();
+    for (u32 i = 0; i < EVCB_MAX; i++) {
+        if (evcb[i].status == EVENT_STATUS::ENABLED && evcb[i].ev == ev && evcb[i].spec == spec && evcb[i].mode == EVENT_MODE::CALLBACK)
+            return true;
+    }
+    return false;
+}
+
+// Delivers an event that has no callback (checked with EventHasCallback), without any soft call
+void DeliverEventNoCallback(u32 ev, u32 spec) {
+    u32 slot = DeliverEventScan(ev, spec, 0);
+    dbg_check(slot >= EVCB_MAX, "DeliverEventNoCallback: event has a callback");
+    (void)slot;
+}
+
+#if HLE_ENABLE_YIELD
+struct DeliverEventFrame {
+    u32 ev;
+    u32 spec;
+    u32 slot; // next EVCB entry to scan
+};
+
+static void DeliverEventStep(const DeliverEventFrame& f) {
+    u32 slot = DeliverEventScan(f.ev, f.spec, f.slot);
+    if (slot < EVCB_MAX) {
+        HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_DeliverEvent, 1), DeliverEventFrame{ f.ev, f.spec, slot + 1 });
+        pc0 = GetEVCB()[slot].fhandler;
+        return;
+    }
+
+    pc0 = ra;
+}
+
+// Resume point after an event callback
+static void hleKernel_DeliverEvent(HLE_BIOS_CALL_ARGS) {
+    DeliverEventFrame f;
+    HleYieldPop(f);
+    DeliverEventStep(f);
+}
+#endif
+
+// In yield mode, DeliverEvent is an HLE subroutine: it completes with `pc0 = ra` (see psxhle-yieldcall.cpp)
 void DeliverEvent(u32 ev, u32 spec) {
 #if 1
     // Quite spammy due to default kernel IRQ (vsync and timers)
@@ -41,15 +103,14 @@ void DeliverEvent(u32 ev, u32 spec) {
         PSXBIOS_LOG("DeliverEvent %8x;%x", ev, spec);
 #endif
 
+#if HLE_ENABLE_YIELD
+    DeliverEventStep({ ev, spec, 0 });
+#else
     auto evcb = GetEVCB();
-    for (u32 i = 0; i < EVCB_MAX; i++) {
-        if (evcb[i].status == EVENT_STATUS::ENABLED && evcb[i].ev == ev && evcb[i].spec == spec) {
-            if (evcb[i].mode == EVENT_MODE::CALLBACK)
-                softCall(evcb[i].fhandler);
-            else
-                evcb[i].status = EVENT_STATUS::DELIVERED;
-        }
+    for (u32 i = DeliverEventScan(ev, spec, 0); i < EVCB_MAX; i = DeliverEventScan(ev, spec, i + 1)) {
+        softCall(evcb[i].fhandler);
     }
+#endif
 }
 
 void PostAsyncEvent(uint32_t ev, uint16_t spec, uint16_t port, uint16_t repeat) {
@@ -89,11 +150,86 @@ void PostAsyncEvent(uint32_t ev, uint16_t spec, uint16_t port, uint16_t repeat)
 #endif
 }
 
+// Mark async commands as done before their events are delivered
+static void ClearAsyncBusyInfo(const AsyncEventInfo* events, uint32_t nb) {
+    for (uint32_t i = 0; i < nb; i++) {
+        if (events[i].port == INVALID_PORT) {
+            // Invalid port. Clear all bits
+            g_hle->busy_card_info = 0;
+        } else {
+            uint32_t port_flag = (1u << events[i].port);
+            g_hle->busy_card_info &= ~port_flag;
+        }
+    }
+}
+
+static uint32_t GetAsyncEventRepeat(const AsyncEventInfo& e) {
+    // Repeat same events multiple time (typically 1 event for every 128B sector read/written)
+    uint32_t repeat = std::max((uint32_t)e.repeat, 1u);
+    // Keep compatibility with older savestate which didn't have the repeat info but a 16b port value
+    if (e.port == INVALID_PORT && e.repeat == INVALID_REPEAT) {
+        repeat = 1;
+    }
+    return repeat;
+}
+
+#if HLE_ENABLE_YIELD
+struct DeliverAsyncEventFrame {
+    u32 event;  // index in g_hle->async_deliver
+    u32 repeat; // number of deliveries already done for this event
+};
+
+static void DeliverAsyncEventStep(DeliverAsyncEventFrame f) {
+    if (f.event < g_hle->async_deliver_nb) {
+        if (f.repeat >= GetAsyncEventRepeat(g_hle->async_deliver[f.event])) {
+            f.event++;
+            f.repeat = 0;
+        }
+    }
+
+    if (f.event < g_hle->async_deliver_nb) {
+        const auto& e = g_hle->async_deliver[f.event];
+        HleYieldPush(HleMakeYieldUid(HLE_THUNK_KERNEL, HLE_KCALL_DeliverAsyncEvent, 1), DeliverAsyncEventFrame{ f.event, f.repeat + 1 });
+        DeliverEvent(e.ev, e.spec);
+        return;
+    }
+
+    g_hle->async_deliver_nb = 0;
+    pc0 = ra;
+}
+
+// Resume point after the delivery of one event
+static void hleKernel_DeliverAsyncEvent(HLE_BIOS_CALL_ARGS) {
+    DeliverAsyncEventFrame f;
+    HleYieldPop(f);
+    DeliverAsyncEventStep(f);
+}
+#endif
+
+// In yield mode, DeliverAsyncEvent is an HLE subroutine: it completes with `pc0 = ra`
 void DeliverAsyncEvent() {
 #if ASYNC_EVENT == 0
     g_hle->busy_card_info = 0;
 #endif
 
+#if HLE_ENABLE_YIELD
+    // The events being delivered are kept in the HLE state (instead of the host stack) so the delivery
+    // survives a savestate. A callback that re-enables IRQs could get us there again; the new events
+    // will simply be delivered on the next interrupt.
+    if (g_hle->async_event_nb == 0 || g_hle->async_deliver_nb != 0) {
+        pc0 = ra;
+        return;
+    }
+
+    uint32_t nb = g_hle->async_event_nb;
+    memcpy(g_hle->async_deliver, g_hle->async_events, nb * sizeof(AsyncEventInfo));
+    g_hle->async_deliver_nb = nb;
+    g_hle->async_event_nb = 0;
+
+    ClearAsyncBusyInfo(g_hle->async_deliver, nb);
+
+    DeliverAsyncEventStep({ 0, 0 });
+#else
     if (g_hle->async_event_nb == 0)
         return;
 
@@ -106,29 +242,24 @@ void DeliverAsyncEvent() {
     g_hle->async_event_nb = 0; // Just clear the number of event
 
     // Before we deliver anyc event, mark async command as done
-    for (uint32_t i = 0; i < nb; i++) {
-        if (events[i].port == INVALID_PORT) {
-            // Invalid port. Clear all bits
-            g_hle->busy_card_info = 0;
-        } else {
-            uint32_t port_flag = (1u << events[i].port);
-            g_hle->busy_card_info &= ~port_flag;
-        }
-    }
+    ClearAsyncBusyInfo(events, nb);
 
     // Note: Delivering Event will updated async command status
     // (aka busy_card_info)
     for (uint32_t i = 0; i < nb; i++) {
-        // Repeat same events multiple time (typically 1 event for every 128B sector read/written)
-        uint32_t repeat = std::max((uint32_t)events[i].repeat, 1u);
-        // Keep compatibility with older savestate which didn't have the repeat info but a 16b port value
-        if (events[i].port == INVALID_PORT && events[i].repeat == INVALID_REPEAT) {
-            repeat = 1;
-        }
+        uint32_t repeat = GetAsyncEventRepeat(events[i]);
         for (uint32_t j = 0; j < repeat; j++) {
             DeliverEvent(events[i].ev, events[i].spec);
         }
     }
+#endif
+}
+
+void initEventsYield() {
+#if HLE_ENABLE_YIELD
+    biosKernel[HLE_KCALL_DeliverEvent]      = hleKernel_DeliverEvent;
+    biosKernel[HLE_KCALL_DeliverAsyncEvent] = hleKernel_DeliverAsyncEvent;
+#endif
 }
 
 static int getFreeEventSlot() {
@@ -144,7 +275,9 @@ void psxBios_DeliverEvent(HLE_BIOS_CALL_ARGS) { // 07
 
     DeliverEvent(a0, a1);
 
+#if !HLE_ENABLE_YIELD
     pc0 = ra;
+#endif
 }
 
 void psxBios_OpenEvent(HLE_BIOS_CALL_ARGS) { // 08
@@ -0,0 +1,432 @@
+#include "psxhle-emu-ifc.h"
+#include "psdisc-endian.h"
+
+#include <unordered_map>
+#include <vector>
+
+#if HLE_DUCKSTATION_IFC
+Log_SetChannel(HLEBIOS);
+#endif
+
+// Host side copy of the IRQ handler chain (G_HANDLERS priority lists)
+//
+// The exception handler used to walk the guest linked lists and soft-call every verifier, even though
+// most of them just read ISTAT and return 0. The lists are flattened here when SysEnqIntRP/SysDeqIntRP
+// update them, and each verifier is analyzed once to find which ISTAT bits it depends on. Verifiers
+// that can't return non-zero for the current ISTAT are skipped without running any guest code.
+//
+// Games are free to edit the lists (or the verifier code) directly, so the copy is checked against guest
+// memory before it is used. A mismatch simply rebuilds it.
+
+// Max number of instructions of a verifier considered by the analysis
+static const u32 kVerifierMaxInsn = 32;
+// Protection against corrupted (looping) lists
+static const u32 kChainMaxEntries = 256;
+
+struct VerifierInfo {
+    bool noop_known;            // verifier returns 0 when (ISTAT & noop_mask) == 0
+    u32  noop_mask;
+    u32  size;                  // number of analyzed instructions
+    u32  code[kVerifierMaxInsn];
+};
+
+struct IrqChainState {
+    bool valid;
+    u32  handlers;              // G_HANDLERS value used to build the chain
+    u32  handler_max;
+    std::vector<u32> heads;     // head of each priority list
+    std::vector<IrqChainEntry> entries;
+    std::unordered_map<u32, VerifierInfo> verifiers; // memoized analysis, keyed by verifier address
+};
+
+static IrqChainState s_chain;
+IrqChainStats g_irq_chain_stats;
+
+// ------------------------------------------------------------------------------------------------
+// Verifier analysis
+//
+// Abstract interpretation of a straight-line MIPS function ending with `jr ra`. Each register holds
+// one of the values below. The analysis fails (verifier is always called) on anything with side effects
+// (stores, calls, syscalls, cop0) or control flow other than the final return.
+
+enum AbsKind : u8 {
+    ABS_UNKNOWN,
+    ABS_CONST,      // known constant
+    ABS_ISTAT,      // bits are a subset of (ISTAT & mask)
+    ABS_DEP,        // unknown value, but 0 whenever (ISTAT & mask) == 0
+};
+
+struct AbsValue {
+    AbsKind kind;
+    u32     val;    // constant or mask
+};
+
+static AbsValue AbsUnknown()        { return { ABS_UNKNOWN, 0 }; }
+static AbsValue AbsConst(u32 c)     { return { ABS_CONST, c }; }
+static AbsValue AbsIstat(u32 mask)  { return { ABS_ISTAT, mask }; }
+static AbsValue AbsDep(u32 mask)    { return { ABS_DEP, mask }; }
+
+static bool AbsIsZero(const AbsValue& v) { return v.kind == ABS_CONST && v.val == 0; }
+static bool AbsIsIstat(const AbsValue& v) { return v.kind == ABS_ISTAT || v.kind == ABS_DEP; }
+
+static AbsValue AbsAnd(const AbsValue& x, const AbsValue& y) {
+    if (AbsIsZero(x) || AbsIsZero(y)) return AbsConst(0);
+    if (x.kind == ABS_CONST && y.kind == ABS_CONST) return AbsConst(x.val & y.val);
+    // A subset of ISTAT stays a subset, and can only lose bits
+    if (x.kind == ABS_ISTAT && (y.kind == ABS_CONST || y.kind == ABS_ISTAT)) return AbsIstat(x.val & y.val);
+    if (y.kind == ABS_ISTAT && x.kind == ABS_CONST) return AbsIstat(y.val & x.val);
+    if (x.kind == ABS_ISTAT) return AbsIstat(x.val);
+    if (y.kind == ABS_ISTAT) return AbsIstat(y.val);
+    if (x.kind == ABS_DEP) return AbsDep(x.val);
+    if (y.kind == ABS_DEP) return AbsDep(y.val);
+    return AbsUnknown();
+}
+
+static AbsValue AbsOr(const AbsValue& x, const AbsValue& y) {
+    if (AbsIsZero(x)) return y;
+    if (AbsIsZero(y)) return x;
+    if (x.kind == ABS_CONST && y.kind == ABS_CONST) return AbsConst(x.val | y.val);
+    if (x.kind == ABS_ISTAT && y.kind == ABS_ISTAT) return AbsIstat(x.val | y.val);
+    if (AbsIsIstat(x) && AbsIsIstat(y)) return AbsDep(x.val | y.val);
+    return AbsUnknown();
+}
+
+// Operations that map 0 to 0 (shifts, != 0 tests)
+static AbsValue AbsZeroPreserving(const AbsValue& x) {
+    if (AbsIsIstat(x)) return AbsDep(x.val);
+    return AbsUnknown();
+}
+
+static AbsValue AbsLoadWord(const AbsValue& base, s16 offset) {
+    if (base.kind != ABS_CONST) return AbsUnknown();
+
+    u32 addr = (base.val + (s32)offset) & PS1_SegmentAddrMask;
+    if (addr == 0x1f801070) return AbsIstat(0xffffffff);
+    return AbsUnknown();
+}
+
+static bool AnalyzeVerifier(u32 addr, VerifierInfo& info) {
+    info.noop_known = false;
+    info.noop_mask = 0;
+    info.size = 0;
+
+    // Only consider code in main RAM
+    if ((addr & 3) || (addr & PS1_SegmentAddrMask) >= PS1_RamMirrorSize)
+        return false;
+
+    AbsValue regs[32];
+    for (auto& r : regs) r = AbsUnknown();
+    regs[0] = AbsConst(0);
+
+    // R3000 load delay: the loaded value is visible after the next instruction
+    u32 load_reg = 0;
+    AbsValue load_val = AbsUnknown();
+    bool returning = false;
+
+    for (u32 i = 0; i < kVerifierMaxInsn; i++) {
+        u32 op = LoadFromLE(psxMu32ref(addr + i * 4));
+        info.code[i] = op;
+        info.size = i + 1;
+
+        bool delay_slot = returning;
+        u32 rs = (op >> 21) & 31;
+        u32 rt = (op >> 16) & 31;
+        u32 rd = (op >> 11) & 31;
+        u32 sa = (op >>  6) & 31;
+        u16 imm = op & 0xffff;
+        const AbsValue& vs = regs[rs];
+        const AbsValue& vt = regs[rt];
+
+        u32 dst = 0;
+        AbsValue res = AbsUnknown();
+        u32 new_load_reg = 0;
+        AbsValue new_load_val = AbsUnknown();
+
+        switch (op >> 26) {
+            case 0x00: // SPECIAL
+                switch (op & 0x3f) {
+                    case 0x00: // sll
+                    case 0x02: // srl
+                    case 0x03: // sra
+                        dst = rd;
+                        if (vt.kind == ABS_CONST) {
+                            switch (op & 0x3f) {
+                                case 0x00: res = AbsConst(vt.val << sa);                break;
+                                case 0x02: res = AbsConst(vt.val >> sa);                break;
+                                default:   res = AbsConst((u32)((s32)vt.val >> sa));    break;
+                            }
+                        } else {
+                            res = (sa == 0) ? vt : AbsZeroPreserving(vt);
+                        }
+                        break;
+                    case 0x08: // jr
+                        if (rs != 31 || delay_slot) return false;
+                        returning = true;
+                        break;
+                    case 0x21: // addu
+                        dst = rd;
+                        if (AbsIsZero(vs)) res = vt;
+                        else if (AbsIsZero(vt)) res = vs;
+                        else if (vs.kind == ABS_CONST && vt.kind == ABS_CONST) res = AbsConst(vs.val + vt.val);
+                        break;
+                    case 0x24: dst = rd; res = AbsAnd(vs, vt);  break; // and
+                    case 0x25: dst = rd; res = AbsOr (vs, vt);  break; // or
+                    case 0x2b: // sltu
+                        dst = rd;
+                        // sltu rd, zero, rt => rt != 0
+                        if (AbsIsZero(vs)) res = (vt.kind == ABS_CONST) ? AbsConst(vt.val != 0) : AbsZeroPreserving(vt);
+                        break;
+                    case 0x04: case 0x06: case 0x07:                        // sllv srlv srav
+                    case 0x23: case 0x26: case 0x27: case 0x2a:             // subu xor nor slt
+                        dst = rd;
+                        break;
+                    default:
+                        // add/sub (overflow exception), mult/div, syscall, break, jalr...
+                        return false;
+                }
+                break;
+
+            case 0x09: // addiu
+                dst = rt;
+                if (vs.kind == ABS_CONST) res = AbsConst(vs.val + (s32)(s16)imm);
+                else if (imm == 0) res = vs;
+                break;
+            case 0x0c: dst = rt; res = AbsAnd(vs, AbsConst(imm));   break; // andi
+            case 0x0d: dst = rt; res = AbsOr (vs, AbsConst(imm));   break; // ori
+            case 0x0f: dst = rt; res = AbsConst((u32)imm << 16);    break; // lui
+            case 0x0a: case 0x0b: case 0x0e:                               // slti sltiu xori
+                dst = rt;
+                break;
+
+            case 0x23: // lw
+                new_load_reg = rt;
+                new_load_val = AbsLoadWord(vs, (s16)imm);
+                break;
+            case 0x20: case 0x21: case 0x24: case 0x25: // lb lh lbu lhu
+                new_load_reg = rt;
+                break;
+
+            default:
+                // stores, branches, jumps, coprocessors...
+                return false;
+        }
+
+        // Retire the previous load, then the current instruction
+        if (load_reg != 0) regs[load_reg] = (load_reg == dst) ? AbsUnknown() : load_val;
+        if (dst != 0) regs[dst] = (load_reg == dst) ? AbsUnknown() : res;
+        load_reg = new_load_reg;
+        load_val = new_load_val;
+
+        if (delay_slot) {
+            // A load in the delay slot of `jr ra` is visible to the caller
+            if (load_reg != 0) regs[load_reg] = load_val;
+
+            const AbsValue& result = regs[2];
+            if (AbsIsZero(result)) {
+                info.noop_known = true;
+                info.noop_mask = 0;
+            } else if (AbsIsIstat(result)) {
+                info.noop_known = true;
+                info.noop_mask = result.val;
+            }
+            return info.noop_known;
+        }
+    }
+
+    return false;
+}
+
+static const VerifierInfo& GetVerifierInfo(u32 verifier) {
+    auto it = s_chain.verifiers.find(verifier);
+    if (it != s_chain.verifiers.end()) {
+        // Overlays can replace the code at the same address
+        const auto& info = it->second;
+        bool same = true;
+        for (u32 i = 0; i < info.size && same; i++)
+            same = LoadFromLE(psxMu32ref(verifier + i * 4)) == info.code[i];
+        if (same)
+            return info;
+    }
+
+    auto& info = s_chain.verifiers[verifier];
+    if (AnalyzeVerifier(verifier, info)) {
+        PSXBIOS_LOG_IRQ("IRQ verifier %08x is a no-op unless ISTAT & %08x", verifier, info.noop_mask);
+    }
+    return info;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Chain
+
+static u32 GetPrioHead(u32 handlers, u32 prio) {
+    return LoadFromLE(psxMu32ref(handlers + prio * SIZEOF_HANDLER));
+}
+
+void IrqChainRebuild() {
+    s_chain.valid = true;
+    s_chain.handlers = LoadFromLE(psxMu32ref(G_HANDLERS));
+    s_chain.handler_max = HANDLER_MAX;
+    s_chain.heads.assign(HANDLER_MAX, 0);
+    s_chain.entries.clear();
+    g_irq_chain_stats.rebuilds++;
+
+    if (s_chain.handlers == 0)
+        return;
+
+    for (u32 prio = 0; prio < HANDLER_MAX; prio++) {
+        u32 node = GetPrioHead(s_chain.handlers, prio);
+        s_chain.heads[prio] = node;
+
+        while (node != 0) {
+            if (s_chain.entries.size() >= kChainMaxEntries) {
+                // Corrupted list. Don't trust the copy, let the guest memory decide.
+                PSXBIOS_LOG("ERROR: IRQ handler chain too long (loop?)");
+                s_chain.valid = false;
+                return;
+            }
+
+            auto* h = (HandlerInfo*)PSXM(node);
+            IrqChainEntry e = {};
+            e.prio = prio;
+            e.node = node;
+            e.next = LoadFromLE(h->next);
+            e.handler = LoadFromLE(h->handler);
+            e.verifier = LoadFromLE(h->verifier);
+            if (e.verifier) {
+                const auto& info = GetVerifierInfo(e.verifier);
+                e.noop_known = info.noop_known;
+                e.noop_mask = info.noop_mask;
+            }
+            s_chain.entries.push_back(e);
+            node = e.next;
+        }
+    }
+}
+
+void IrqChainInvalidate() {
+    s_chain.valid = false;
+}
+
+// Checks the flattened copy against guest memory, rebuild it when the game edited the lists directly
+static void IrqChainValidate() {
+    bool same = s_chain.valid
+        && s_chain.handlers == LoadFromLE(psxMu32ref(G_HANDLERS))
+        && s_chain.handler_max == HANDLER_MAX;
+
+    for (u32 prio = 0; same && prio < s_chain.handler_max; prio++)
+        same = s_chain.heads[prio] == GetPrioHead(s_chain.handlers, prio);
+
+    for (u32 i = 0; same && i < s_chain.entries.size(); i++) {
+        const auto& e = s_chain.entries[i];
+        auto* h = (HandlerInfo*)PSXM(e.node);
+        same = e.next == LoadFromLE(h->next) && e.handler == LoadFromLE(h->handler) && e.verifier == LoadFromLE(h->verifier);
+    }
+
+    if (!same) {
+        if (s_chain.valid)
+            PSXBIOS_LOG_IRQ("IRQ handler chain was modified by the game");
+        IrqChainRebuild();
+    }
+}
+
+IrqChainCursor IrqChainBegin(bool checked) {
+    if (!checked)
+        IrqChainValidate();
+
+    IrqChainCursor c = {};
+    c.prio = 0;
+    c.node = GetPrioHead(LoadFromLE(psxMu32ref(G_HANDLERS)), 0);
+    c.index = 0;
+    return c;
+}
+
+// Find the entry of c.node. The hint matches unless the chain changed under our feet.
+static bool IrqChainLookup(IrqChainCursor& c, IrqChainEntry& e) {
+    auto& entries = s_chain.entries;
+    if (s_chain.valid) {
+        if (c.index < entries.size() && entries[c.index].prio == c.prio && entries[c.index].node == c.node) {
+            e = entries[c.index++];
+            return true;
+        }
+        for (u32 i = 0; i < entries.size(); i++) {
+            if (entries[i].prio == c.prio && entries[i].node == c.node) {
+                c.index = i;
+                e = entries[c.index++];
+                return true;
+            }
+        }
+    }
+
+    // The node was removed from the chain by a handler (or the chain is corrupted).
+    // Visit it anyway like the original BIOS, which reads the next pointer before calling the handler.
+    auto* h = (HandlerInfo*)PSXM(c.node);
+    e = {};
+    e.prio = c.prio;
+    e.node = c.node;
+    e.next = LoadFromLE(h->next);
+    e.handler = LoadFromLE(h->handler);
+    e.verifier = LoadFromLE(h->verifier);
+    return false;
+}
+
+bool IrqChainNext(IrqChainCursor& c, IrqChainEntry& e) {
+    // Guest code ran since the last call, it might have edited the chain
+    if (c.called) {
+        IrqChainValidate();
+        c.called = 0;
+    }
+
+    u32 handlers = LoadFromLE(psxMu32ref(G_HANDLERS));
+    for (;;) {
+        while (c.node == 0) {
+            if (++c.prio >= HANDLER_MAX)
+                return false;
+            c.node = GetPrioHead(handlers, c.prio);
+        }
+
+        IrqChainLookup(c, e);
+        c.node = e.next; // Update linked list pointer
+
+        // In case someone got the idea to read those register to get info on current handler
+        s0 = e.handler;
+        s1 = e.verifier;
+
+        if (!e.verifier)
+            continue;
+
+        if (e.noop_known && (Read_ISTAT() & e.noop_mask) == 0) {
+            // Make sure the code wasn't replaced since the analysis
+            const auto& info = GetVerifierInfo(e.verifier);
+            if (info.noop_known && (Read_ISTAT() & info.noop_mask) == 0) {
+                // Same result as calling it
+                v0 = 0;
+                g_irq_chain_stats.verifier_skipped++;
+                continue;
+            }
+        }
+
+        g_irq_chain_stats.verifier_called++;
+        c.called = 1;
+        return true;
+    }
+}
+
+bool IrqChainHasVerifier(u32 istat) {
+    IrqChainValidate();
+    if (!s_chain.valid)
+        return true;
+
+    for (const auto& e : s_chain.entries) {
+        if (!e.verifier)
+            continue;
+        const auto& info = GetVerifierInfo(e.verifier);
+        if (!info.noop_known || (istat & info.noop_mask) != 0)
+            return true;
+    }
+    return false;
+}
+
+const IrqChainEntry* IrqChainGetEntries(u32& count) {
+    count = (u32)s_chain.entries.size();
+    return s_chain.entries.data();
+}
@@ -138,6 +138,15 @@ u8 PAD_poll(int port, u8 in) {
 bool PAD_connected(int port) {
     return true;
 }
+
+int PAD_transfer_block(int port, u8 cmd, u8* out, int len) {
+    // PCSX plugins don't report the acknowledge line, the whole buffer is always transferred
+    PAD_startPoll(port);
+    for (int i = 0; i < len; i++) {
+        out[i] = PAD_poll(port, (i == 0) ? cmd : 0);
+    }
+    return len;
+}
 #endif
 
 #if HLE_DUCKSTATION_IFC
@@ -159,4 +168,29 @@ u8 PAD_poll(int port, u8 in) {
 void PAD_startPoll(int port) {
     PAD_poll(port, 0x01);
 }
+
+int PAD_transfer_block(int port, u8 cmd, u8* out, int len) {
+    const u8 hiz = 0xff;
+    memset(out, hiz, len);
+
+    auto controller = g_pad.GetController(port);
+    if (controller == nullptr)
+        return 0;
+
+    // Start from a clean state, a previous transfer may have been cut short
+    controller->ResetTransferState();
+
+    u8 dummy = hiz;
+    if (!controller->Transfer(0x01, &dummy))
+        return 0;
+
+    int i = 0;
+    while (i < len) {
+        bool ack = controller->Transfer((i == 0) ? cmd : 0, &out[i]);
+        i++;
+        if (!ack)
+            break;
+    }
+    return i;
+}
 #endif
@@ -61,6 +61,11 @@
 
 // Controls yield behavior, whether the emulator runs recursively into an interpreter or attempts to
 // yield out instead.
+//
+// When enabled, HLE calls that need to run guest code (event callbacks, IRQ verifiers/handlers, qsort
+// comparator) push their state on the guest stack and return to the CPU loop with $ra pointing to a magic
+// address (kSoftCallBaseRetAddr | HleYieldUid). The emulator must forward any pc in that range to
+// HleDispatchCall, which resumes the suspended HLE call. No recursive interpreter is required.
 #if !defined(HLE_ENABLE_YIELD)
 #   define HLE_ENABLE_YIELD     0
 #endif
@@ -392,15 +397,20 @@ void PAD_startPoll(int port);
 uint8_t PAD_poll(int port, uint8_t in);
 bool PAD_connected(int port);
 
+// Runs a full controller transfer in one call: selects the port (0x01), sends `cmd` then zeroes, and
+// stores the response (controller id, 0x5a, data...) in out[0..len). The transfer stops at the first byte
+// the controller doesn't acknowledge; remaining bytes are set to 0xff (hi-z).
+// Returns the number of received bytes (0 when nothing is connected).
+int PAD_transfer_block(int port, uint8_t cmd, uint8_t* out, int len);
+
 // HleYieldUid is a combination of the following traits:
-//  - the BIOS call table thunk address (A0/B0/C0 are standard BIOS thunks), max value 0xffff
+//  - the BIOS call table thunk address (A0/B0/C0 are standard BIOS thunks), max value 0xff
 //  - the BIOS call ID (the thunk uses this to look up the callsite), max value 0xff
-//  - the yield state of the HLE call being invoked (0 = first entry), max value 0xff
+//  - the yield state of the HLE call being invoked (0 = first entry), max value 0x3f
 //
-// The original BIOS has thunks at A0/B0/C0. A custom HLE could add pseudo-addresses.
-// The yield state is determined by the yield system API, which auto-increments the yield state at each
-// call to a yield site.
-HleYieldUid MakeYieldCallId(uint32_t biosCallPage, uint32_t biosCallId);
+// The original BIOS has thunks at A0/B0/C0. A custom HLE could add pseudo-addresses (see HLE_THUNK_KERNEL).
+// The yield state is stored in bits 2..7 so that the resulting magic return address stays word aligned,
+// which is required since the CPU fetches an instruction from it before handing it over to HleDispatchCall.
 
 static bool IsHlePC(u32 pc) {
     return ((pc & 0xff00'0000) == kSoftCallBaseRetAddr);
@@ -408,13 +418,17 @@ static bool IsHlePC(u32 pc) {
 
 // tableAddress - eg. A0, B0, C0
 static HleYieldUid HleMakeYieldUid(u32 thunkAddr, u32 callIdx, u32 yieldIdx) {
-    dbg_check(thunkAddr <= 0xffff);
-    dbg_check(yieldIdx   <= 0xff);
+    dbg_check(thunkAddr <= 0xff);
+    dbg_check(yieldIdx   <= 0x3f);
     dbg_check(callIdx    <= 0xff);
 
-    return ((thunkAddr << 16) | (callIdx << 8) | yieldIdx);
+    return ((thunkAddr << 16) | (callIdx << 8) | (yieldIdx << 2));
 }
 
+static u32 HleGetYieldThunk(HleYieldUid uid) { return (uid >> 16) & 0xff; }
+static u32 HleGetYieldCall (HleYieldUid uid) { return (uid >>  8) & 0xff; }
+static u32 HleGetYieldState(HleYieldUid uid) { return (uid >>  2) & 0x3f; }
+
 static HleYieldUid HleGetCallId(u32 pc) {
     return (HleYieldUid)(pc & ~kSoftCallBaseRetAddr);
 }
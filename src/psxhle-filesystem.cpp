@@ -9,10 +9,47 @@
 #include "posix_file.h"
 #include "defer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #if HLE_PCSX_IFC
 #   include "plugins.h"
 #endif
 
+// mmap backend for the images opened by the HLE itself (PCSX)
+#if HLE_PCSX_IFC && !defined(_WIN32)
+#   define HLE_FS_MMAP 1
+#   include <sys/mman.h>
+#else
+#   define HLE_FS_MMAP 0
+#endif
+
+// mmap of the index cache files, on any host which has it
+#if !defined(_WIN32)
+#   define HLE_FS_MMAP_INDEX 1
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#else
+#   define HLE_FS_MMAP_INDEX 0
+#endif
+
+#if defined(_WIN32)
+#   include <process.h>
+#   define getpid _getpid
+#else
+#   include <unistd.h>
+#endif
+
 // verbose information is logged to stderr to avoid corrupting stdout behavior.
 // (stdout information may be used by other scripts in automation pipeline)
 static bool g_bVerbose = 0;
@@ -23,87 +60,549 @@ struct fileEnt_t
     psdisc_off_t    parent_sector;
     psdisc_off_t    len_bytes;
     int             type;
-    char            name[kPsDiscMaxFileNameLength+1];
+    uint32_t        name_offset;        // into DiscIndex::namePool (nul-terminated)
 
     bool isRoot() const {
         return parent_sector == 0;
     }
 };
 
-// FilesBySectorLUT allows indexing file information quickly according to sector seek position.
+// Contiguous run of sectors owned by a single file. Sorted by start sector once the filesystem is parsed,
+// which allows indexing file information quickly according to sector seek position (binary search).
 // useful for reverse-lookup of current file being read by an emulator.
+struct SectorExtent
+{
+    psdisc_sec_t    start_sector;
+    uint32_t        sector_count;
+    uint32_t        file_id;            // into DiscIndex::files
+};
+
+// Open-addressing hash table of full paths. Keys are normalized (uppercase, '/' separators, no mount
+// prefix, no leading slash, no revision suffix) and stored in DiscIndex::pathPool. Lookups normalize the
+// guest path on the fly, so that no allocation happens on the lookup path.
+struct PathSlot
+{
+    uint32_t        hash;
+    uint32_t        file_id;            // kPathSlotEmpty if unused
+    uint32_t        path_offset;        // into DiscIndex::pathPool
+    uint32_t        path_len;
+};
+
+static const uint32_t kPathSlotEmpty = UINT32_MAX;
+
+// Parsed filesystem of a disc. It's immutable once built and refcounted: the recently used indexes are kept
+// by fingerprint (see the index LRU), so a disc swapped back in, or prefetched from the playlist, reuses the
+// same copy. The rest of the HLE filesystem state (current index, builder, backend) is process-global: it
+// supports a single emulator context.
+struct DiscIndex
+{
+    uint64_t                    fingerprint;        // 0 if the media isn't ISO9660 (not interned)
+    uint64_t                    media_sectors;
+    std::vector<fileEnt_t>      files;
+    std::vector<char>           namePool;
+    std::vector<SectorExtent>   extents;
+    std::vector<PathSlot>       pathSlots;          // size is a power of 2
+    std::vector<char>           pathPool;
+
+    // directory sector -> [first, end) of its entries in files. The entries of a directory are added in a
+    // single batch, so they're contiguous. Rebuilt when the index is loaded from the cache.
+    std::unordered_map<psdisc_off_t, std::pair<uint32_t, uint32_t>> children;
+
+    const char* name(const fileEnt_t& fe) const {
+        return namePool.data() + fe.name_offset;
+    }
+
+    const fileEnt_t* FindFile(const char* path) const;
+    const fileEnt_t* FindFileBySector(psdisc_sec_t sector) const;
+};
+
+using DiscIndexPtr = std::shared_ptr<const DiscIndex>;
 
-using FilesBySectorLUT      = std::map <psdisc_off_t,fileEnt_t>;
-using FilesByFullpathLUT    = std::map <fs::path,fileEnt_t>;
-using DirsBySectorLUT       = std::map <psdisc_off_t,fs::path>;
+// index of the current media, null while it's being built. Only assigned and read on the emulation thread,
+// which is why lookups don't take any lock.
+static DiscIndexPtr         s_index;
 
-FilesBySectorLUT      m_filesBySector;
-FilesByFullpathLUT    m_filesByFullpath;
-DirsBySectorLUT       m_dirsBySector;
+// SYSTEM.CNF of the current media. It's parsed after the index is published, so it's kept apart from the
+// (immutable) index. Emulation thread only.
+static PSX_BOOT_INFO        s_boot_info;
 
-// currently must be done as a separate pass, since AddFile may not be called in dir-followed-by-files order.
-void buildFilesByDirLUT()
+// Guest path reduced to its lookup key, still pointing into the caller string.
+struct PathKey
 {
-    for(const auto& item : m_filesBySector) {
-        auto& fe = item.second;
-        auto dir = m_dirsBySector[fe.parent_sector] / fe.name;
-        m_filesByFullpath.insert({dir, fe});
+    const char*     ptr;
+    size_t          len;
+};
+
+static PathKey psxFs_PathKey(const char* src) {
+    constexpr char mnt_cdrom[] = "cdrom:";
+    if (strncasecmp(src, mnt_cdrom, sizeof(mnt_cdrom) - 1) == 0) {
+        src += sizeof(mnt_cdrom) - 1;
+    }
+
+    // skip rooted slash. All paths are assumed to be rooted.
+    // (there is no CWD mechanic within the psFs)
+
+    while (src[0] == '/' || src[0] == '\\') ++src;
+
+    auto len = strlen(src);
+    if (len >= 3 && src[len-2] == ';') {
+        len -= 2;
     }
+    return { src, len };
 }
 
-void recurse_parent_walk(fs::path& dest, psdisc_off_t parent) {
-    const auto& psec = m_filesBySector[parent];
-    if (psec.parent_sector) {
-        recurse_parent_walk(dest, psec.parent_sector);
+static inline char PathKeyChar(char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a' + 'A';
+    if (c == '\\') return '/';
+    return c;
+}
+
+// FNV-1a
+static uint32_t PathKeyHash(const char* src, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (uint8_t)PathKeyChar(src[i])) * 16777619u;
     }
-    if (psec.name[0]) {
-        dest /= psec.name;
+    return hash;
+}
+
+static bool PathKeyEquals(const DiscIndex& idx, const PathSlot& slot, const char* src, size_t len) {
+    if (slot.path_len != len) return false;
+
+    auto* key = idx.pathPool.data() + slot.path_offset;
+    for (size_t i = 0; i < len; ++i) {
+        if (key[i] != PathKeyChar(src[i])) return false;
     }
+    return true;
 }
 
-void AddFile(psdisc_off_t secstart, psdisc_off_t len, int type, const uint8_t* name, int nameLen, psdisc_off_t parent)
-{
-    dbg_check( nameLen <= kPsDiscMaxFileNameLength );
+const fileEnt_t* DiscIndex::FindFile(const char* path) const {
+    if (!path || pathSlots.empty()) return nullptr;
 
-    if (g_bVerbose) {
-        log_error( "(psxfs) AddFile [parent=%-6jd sector=%-6jd len=%-10jd]: %s",
-            JFMT(parent), JFMT(secstart), JFMT(len), name
-        );
+    auto key  = psxFs_PathKey(path);
+    auto hash = PathKeyHash(key.ptr, key.len);
+    auto mask = (uint32_t)pathSlots.size() - 1;
+
+    for (auto idx = hash & mask; ; idx = (idx + 1) & mask) {
+        auto& slot = pathSlots[idx];
+        if (slot.file_id == kPathSlotEmpty) {
+            return nullptr;
+        }
+        if (slot.hash == hash && PathKeyEquals(*this, slot, key.ptr, key.len)) {
+            return &files[slot.file_id];
+        }
+    }
+}
+
+// returns nullptr if the sector doesn't belong to any file.
+const fileEnt_t* DiscIndex::FindFileBySector(psdisc_sec_t sector) const {
+    auto it = std::upper_bound(extents.begin(), extents.end(), sector, [](psdisc_sec_t sec, const SectorExtent& ext) {
+        return sec < ext.start_sector;
+    });
+    if (it == extents.begin()) {
+        return nullptr;
+    }
+    --it;
+    if (sector >= it->start_sector + it->sector_count) {
+        return nullptr;
     }
+    return &files[it->file_id];
+}
+
+static void psxFs_InsertPath(DiscIndex& idx, const std::string& path, uint32_t file_id) {
+    auto key  = psxFs_PathKey(path.c_str());
+    auto hash = PathKeyHash(key.ptr, key.len);
+    auto mask = (uint32_t)idx.pathSlots.size() - 1;
+
+    for (auto pos = hash & mask; ; pos = (pos + 1) & mask) {
+        auto& slot = idx.pathSlots[pos];
+        if (slot.file_id == kPathSlotEmpty) {
+            slot.hash           = hash;
+            slot.file_id        = file_id;
+            slot.path_offset    = (uint32_t)idx.pathPool.size();
+            slot.path_len       = (uint32_t)key.len;
+            for (size_t i = 0; i < key.len; ++i) {
+                idx.pathPool.push_back(PathKeyChar(key.ptr[i]));
+            }
+            return;
+        }
+        if (slot.hash == hash && PathKeyEquals(idx, slot, key.ptr, key.len)) {
+            // first one wins.
+            return;
+        }
+    }
+}
 
-    if (m_filesBySector.count(secstart)) {
-        log_error("(psxfs) Suspicious duplicate encountered [parent=%-6jd sector=%-6jd len=%-10jd]: %s",
-            JFMT(parent), JFMT(secstart), JFMT(len), name
+// Misses are expected (games probing for optional files), so only the first few ones and then every
+// power of 2 are reported.
+static void psxFs_LogMiss(const char* func, const char* path) {
+    static uint32_t s_miss_count;
+    auto count = ++s_miss_count;
+    if (count <= 16 || (count & (count - 1)) == 0) {
+        log_error("%s: Failed to find %s (%u misses, %u files indexed)", func, path, count,
+            s_index ? (uint32_t)s_index->files.size() : 0
         );
+    }
+}
 
-        return;
+// Builds the path table once the directory walk is complete. Paths are lookup keys (see PathKeyString).
+static void BuildPathSlots(DiscIndex& idx, const std::unordered_map<std::string, uint32_t>& paths)
+{
+    // keep the load factor below 50%
+    uint32_t nslots = 16;
+    while (nslots < paths.size() * 2) nslots *= 2;
+
+    idx.pathSlots.assign(nslots, PathSlot { 0, kPathSlotEmpty, 0, 0 });
+    for (auto& path : paths) {
+        psxFs_InsertPath(idx, path.first, path.second);
     }
+}
 
-    fileEnt_t fe = {};
+static void BuildChildRanges(DiscIndex& idx)
+{
+    idx.children.clear();
+    for (uint32_t id = 0; id < idx.files.size(); ++id) {
+        auto& fe = idx.files[id];
+        if (fe.isRoot()) continue;
+        auto res = idx.children.insert({ fe.parent_sector, { id, id + 1 } });
+        res.first->second.second = id + 1;
+    }
+}
 
-    fe.start_sector     = secstart;
-    fe.parent_sector    = parent;
-    fe.len_bytes        = len;
-    fe.type             = type;
-    memcpy(fe.name, name, nameLen);
-    fe.name[nameLen] = 0;
+static void BuildExtents(DiscIndex& idx)
+{
+    auto& extents = idx.extents;
+    std::sort(extents.begin(), extents.end(), [](const SectorExtent& a, const SectorExtent& b) {
+        return a.start_sector < b.start_sector;
+    });
+
+    // Overlapping files are suspicious (copy protection, corrupted media). The first extent keeps the
+    // overlapped sectors so that the lookup remains a plain binary search.
+    size_t wpos = 0;
+    for (size_t i = 0; i < extents.size(); ++i) {
+        auto& ext = extents[i];
+        if (wpos) {
+            auto& prev = extents[wpos-1];
+            auto  prev_end = prev.start_sector + prev.sector_count;
+            if (ext.start_sector < prev_end) {
+                log_error("(psxfs) Suspicious overlapping file [sector=%-6jd count=%-6u]: %s",
+                    JFMT(ext.start_sector), ext.sector_count, idx.name(idx.files[ext.file_id])
+                );
+                auto ext_end = ext.start_sector + ext.sector_count;
+                if (ext_end <= prev_end) {
+                    continue;
+                }
+                ext.sector_count = (uint32_t)(ext_end - prev_end);
+                ext.start_sector = prev_end;
+            }
+        }
+        extents[wpos++] = ext;
+    }
+    extents.resize(wpos);
+    extents.shrink_to_fit();
+}
 
-    // strip the ECMA-119 semicolon revision info.
-    if (fe.name[nameLen-2] == ';') {
-        fe.name[nameLen-2]  = 0;
+// Lookup key of a guest path, as stored in the path table.
+static std::string PathKeyString(const char* path) {
+    auto key = psxFs_PathKey(path);
+    std::string result(key.len, 0);
+    for (size_t i = 0; i < key.len; ++i) {
+        result[i] = PathKeyChar(key.ptr[i]);
+    }
+    return result;
+}
+
+// --------------------------------------------------------------------------------------
+// Index LRU
+//
+// The most recently used indexes are kept by fingerprint along with their SYSTEM.CNF, so that swapping
+// between the discs of a multi-disc title (and back) only swaps the index pointer. It's also where the
+// playlist prefetch thread hands its indexes over, hence the lock (only taken when the media changes).
+
+struct DiscIndexEntry
+{
+    DiscIndexPtr    index;
+    PSX_BOOT_INFO   boot;
+};
+
+static std::mutex                   s_index_lru_mutex;
+static std::deque<DiscIndexEntry>   s_index_lru;        // most recent first
+static size_t                       s_index_lru_size = 4;
+
+extern "C" void HleSetFsIndexLruSize(int discs) {
+    std::lock_guard<std::mutex> lock(s_index_lru_mutex);
+    s_index_lru_size = std::max(discs, 0);
+    if (s_index_lru.size() > s_index_lru_size) {
+        s_index_lru.resize(s_index_lru_size);
+    }
+}
+
+// Moves the entry of the disc to the front of the LRU. LRU lock held. returns nullptr if it isn't known.
+static DiscIndexEntry* DiscIndexTouch(uint64_t fingerprint) {
+    auto it = std::find_if(s_index_lru.begin(), s_index_lru.end(), [&](const DiscIndexEntry& e) {
+        return e.index->fingerprint == fingerprint;
+    });
+    if (it == s_index_lru.end()) {
+        return nullptr;
+    }
+    if (it != s_index_lru.begin()) {
+        auto entry = std::move(*it);
+        s_index_lru.erase(it);
+        s_index_lru.push_front(std::move(entry));
+    }
+    return &s_index_lru.front();
+}
+
+static DiscIndexPtr DiscIndexLookup(uint64_t fingerprint, PSX_BOOT_INFO& boot) {
+    std::lock_guard<std::mutex> lock(s_index_lru_mutex);
+    if (auto* entry = DiscIndexTouch(fingerprint)) {
+        boot = entry->boot;
+        return entry->index;
+    }
+    return nullptr;
+}
+
+// Returns the index already known for the disc if another thread added it meanwhile (boot is updated
+// accordingly), idx otherwise.
+static DiscIndexPtr DiscIndexIntern(DiscIndexPtr idx, PSX_BOOT_INFO& boot) {
+    if (!idx->fingerprint) return idx;
+
+    std::lock_guard<std::mutex> lock(s_index_lru_mutex);
+    if (auto* entry = DiscIndexTouch(idx->fingerprint)) {
+        if (entry->boot.valid) {
+            boot = entry->boot;
+        }
+        else {
+            entry->boot = boot;
+        }
+        return entry->index;
+    }
+    if (s_index_lru_size) {
+        s_index_lru.push_front({ idx, boot });
+        if (s_index_lru.size() > s_index_lru_size) {
+            s_index_lru.pop_back();
+        }
+    }
+    return idx;
+}
+
+static void DiscIndexSetBoot(uint64_t fingerprint, const PSX_BOOT_INFO& boot) {
+    std::lock_guard<std::mutex> lock(s_index_lru_mutex);
+    for (auto& entry : s_index_lru) {
+        if (entry.index->fingerprint == fingerprint) {
+            entry.boot = boot;
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------
+// Persistent index cache
+//
+// The parsed index is written to <dir>/<fingerprint>.psxfsidx, so that discs booted over and over skip
+// the ISO9660 directory walk and the SYSTEM.CNF parsing. The disc is identified by a hash of the primary
+// volume descriptor and the media size. The file is a header followed by the raw index tables (each one
+// 8-byte aligned), in host endianness. It's mapped (read in one go where mmap isn't available) and the tables
+// are copied straight out of it. Files are replaced by a rename, a mapping never sees a partial write.
+// Any mismatch (version, fingerprint, sizes) falls back on a full parse, which then overwrites the file.
+
+static const char     kIndexCacheMagic[8]   = { 'P','S','X','F','S','I','D','X' };
+static const uint32_t kIndexCacheVersion    = 1;
+
+struct IndexCacheHeader
+{
+    char            magic[8];
+    uint32_t        version;
+    uint32_t        header_size;
+    uint64_t        fingerprint;
+    uint64_t        media_sectors;
+    uint32_t        num_files;
+    uint32_t        name_pool_size;
+    uint32_t        num_extents;
+    uint32_t        num_path_slots;
+    uint32_t        path_pool_size;
+    uint32_t        pad;
+    PSX_BOOT_INFO   boot;
+};
+
+static std::string  s_index_cache_dir;
+static uint64_t     s_media_sectors;
+
+extern "C" void HleSetFsIndexCacheDir(const char* dir) {
+    s_index_cache_dir = dir ? dir : "";
+}
+
+// FNV-1a 64
+static uint64_t FingerprintHash(uint64_t hash, const void* src, size_t len) {
+    auto* bytes = (const uint8_t*)src;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string IndexCachePath(uint64_t fingerprint, const char* ext = "psxfsidx") {
+    char name[48];
+    snprintf(name, sizeof(name), "%016llx.%s", (unsigned long long)fingerprint, ext);
+    return s_index_cache_dir + "/" + name;
+}
+
+static size_t IndexCacheAlign(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+template<typename T>
+static bool IndexCacheReadTable(const uint8_t* src, size_t src_size, size_t& pos, std::vector<T>& dest, uint32_t count) {
+    auto size = sizeof(T) * (uint64_t)count;
+    if (pos > src_size || size > src_size - pos) return false;
+
+    dest.resize(count);
+    if (size) memcpy(dest.data(), src + pos, size);
+    pos += IndexCacheAlign(size);
+    return true;
+}
+
+template<typename T>
+static void IndexCacheWriteTable(FILE* fp, const std::vector<T>& src) {
+    static const uint8_t zeros[8] = {};
+    auto size = sizeof(T) * src.size();
+    if (size) fwrite(src.data(), 1, size, fp);
+    fwrite(zeros, 1, IndexCacheAlign(size) - size, fp);
+}
+
+// Temporary file for a write-then-rename, unique among the threads and processes sharing the directory.
+static std::string UniqueTempPath(const std::string& path) {
+    return path + ".tmp" + std::to_string(getpid()) + "-" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+}
+
+static std::shared_ptr<DiscIndex> IndexCacheParse(const std::string& path, const uint8_t* data, size_t size,
+    uint64_t fingerprint, uint64_t media_sectors, PSX_BOOT_INFO& boot);
+
+static std::shared_ptr<DiscIndex> IndexCacheLoad(uint64_t fingerprint, uint64_t media_sectors, PSX_BOOT_INFO& boot) {
+    if (s_index_cache_dir.empty()) return nullptr;
+
+    auto path = IndexCachePath(fingerprint);
+    auto* fp = fopen(path.c_str(), "rb");
+    if (!fp) return nullptr;
+
+#if HLE_FS_MMAP_INDEX
+    struct stat st;
+    if (fstat(fileno(fp), &st) == 0 && st.st_size >= (off_t)sizeof(IndexCacheHeader)) {
+        auto* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+        if (map != MAP_FAILED) {
+            fclose(fp);
+            auto idx = IndexCacheParse(path, (const uint8_t*)map, st.st_size, fingerprint, media_sectors, boot);
+            munmap(map, st.st_size);
+            return idx;
+        }
+    }
+#endif
+
+    std::vector<uint8_t> data;
+    fseek(fp, 0, SEEK_END);
+    auto size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size >= (long)sizeof(IndexCacheHeader)) {
+        data.resize(size);
+        if (fread(data.data(), 1, size, fp) != (size_t)size) {
+            data.clear();
+        }
+    }
+    fclose(fp);
+
+    if (data.empty()) return nullptr;
+    return IndexCacheParse(path, data.data(), data.size(), fingerprint, media_sectors, boot);
+}
+
+static std::shared_ptr<DiscIndex> IndexCacheParse(const std::string& path, const uint8_t* data, size_t size,
+    uint64_t fingerprint, uint64_t media_sectors, PSX_BOOT_INFO& boot) {
+    if (size < sizeof(IndexCacheHeader)) return nullptr;
+
+    IndexCacheHeader hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    if (memcmp(hdr.magic, kIndexCacheMagic, sizeof(hdr.magic))
+        || hdr.version          != kIndexCacheVersion
+        || hdr.header_size      != sizeof(IndexCacheHeader)
+        || hdr.fingerprint      != fingerprint
+        || hdr.media_sectors    != media_sectors
+        || hdr.num_path_slots   == 0
+        || (hdr.num_path_slots & (hdr.num_path_slots - 1))) {
+        log_host("(psxfs) index cache mismatch, ignoring %s", path.c_str());
+        return nullptr;
+    }
+
+    auto idx = std::make_shared<DiscIndex>();
+    size_t pos = IndexCacheAlign(sizeof(IndexCacheHeader));
+    bool ok = IndexCacheReadTable(data, size, pos, idx->files,     hdr.num_files)
+           && IndexCacheReadTable(data, size, pos, idx->namePool,  hdr.name_pool_size)
+           && IndexCacheReadTable(data, size, pos, idx->extents,   hdr.num_extents)
+           && IndexCacheReadTable(data, size, pos, idx->pathSlots, hdr.num_path_slots)
+           && IndexCacheReadTable(data, size, pos, idx->pathPool,  hdr.path_pool_size);
+
+    for (auto& fe : idx->files) {
+        ok = ok && fe.name_offset < idx->namePool.size();
+    }
+    for (auto& ext : idx->extents) {
+        ok = ok && ext.file_id < idx->files.size();
+    }
+    for (auto& slot : idx->pathSlots) {
+        ok = ok && (slot.file_id == kPathSlotEmpty
+            || (slot.file_id < idx->files.size() && (uint64_t)slot.path_offset + slot.path_len <= idx->pathPool.size()));
+    }
+    ok = ok && !idx->namePool.empty() && idx->namePool.back() == 0;
+    ok = ok && memchr(hdr.boot.boot, 0, sizeof(hdr.boot.boot)) && memchr(hdr.boot.game_code, 0, sizeof(hdr.boot.game_code));
+
+    if (!ok) {
+        log_error("(psxfs) corrupted index cache: %s", path.c_str());
+        return nullptr;
     }
 
-    // allows indexing file information quickly according to sector seek position.
-    // useful for reverse-lookup of current file being read by an emulator.
-    auto seclen = (len + 2047) / 2048;
-    for (auto seci=secstart; seci<secstart+seclen; ++seci) {
-        m_filesBySector.insert({seci, fe});
+    idx->fingerprint    = fingerprint;
+    idx->media_sectors  = media_sectors;
+    boot                = hdr.boot;
+    BuildChildRanges(*idx);
+    log_host("(psxfs) loaded index cache %s (%u files)", path.c_str(), hdr.num_files);
+    return idx;
+}
+
+static void IndexCacheStore(const DiscIndex& idx, const PSX_BOOT_INFO& boot) {
+    if (s_index_cache_dir.empty() || !idx.fingerprint) return;
+
+    IndexCacheHeader hdr = {};
+    memcpy(hdr.magic, kIndexCacheMagic, sizeof(hdr.magic));
+    hdr.version         = kIndexCacheVersion;
+    hdr.header_size     = sizeof(IndexCacheHeader);
+    hdr.fingerprint     = idx.fingerprint;
+    hdr.media_sectors   = idx.media_sectors;
+    hdr.num_files       = (uint32_t)idx.files.size();
+    hdr.name_pool_size  = (uint32_t)idx.namePool.size();
+    hdr.num_extents     = (uint32_t)idx.extents.size();
+    hdr.num_path_slots  = (uint32_t)idx.pathSlots.size();
+    hdr.path_pool_size  = (uint32_t)idx.pathPool.size();
+    hdr.boot            = boot;
+
+    // write-then-rename so that concurrent instances never see a partial file.
+    auto path = IndexCachePath(idx.fingerprint);
+    auto tmppath = UniqueTempPath(path);
+    auto* fp = fopen(tmppath.c_str(), "wb");
+    if (!fp) {
+        log_error("(psxfs) can't write index cache %s: %s", tmppath.c_str(), strerror(errno));
+        return;
     }
 
-    if (type == FILETYPE_DIR) {
-        fs::path dirdest;
-        recurse_parent_walk(dirdest, secstart);
-        m_dirsBySector.insert({secstart, dirdest});
+    static const uint8_t zeros[8] = {};
+    fwrite(&hdr, 1, sizeof(hdr), fp);
+    fwrite(zeros, 1, IndexCacheAlign(sizeof(hdr)) - sizeof(hdr), fp);
+    IndexCacheWriteTable(fp, idx.files);
+    IndexCacheWriteTable(fp, idx.namePool);
+    IndexCacheWriteTable(fp, idx.extents);
+    IndexCacheWriteTable(fp, idx.pathSlots);
+    IndexCacheWriteTable(fp, idx.pathPool);
+
+    bool ok = !ferror(fp);
+    fclose(fp);
+    if (!ok || rename(tmppath.c_str(), path.c_str()) != 0) {
+        log_error("(psxfs) can't write index cache %s", path.c_str());
+        remove(tmppath.c_str());
     }
 }
 
@@ -122,11 +621,89 @@ std::unique_ptr<CDImage> ds_cdimage = nullptr;
 std::string s_iso_path = "";
 #endif
 
+static bool s_mmap_enabled;
+
+extern "C" void HleSetFsMmap(int enable) {
+    // takes effect the next time an image is opened (only images opened by the HLE can be mapped)
+    s_mmap_enabled = !!enable;
+}
+
 #if HLE_PCSX_IFC
 static int s_fd = -1;
 static MediaSourceDescriptor s_media;
 static PsDisc_IO_Interface s_ioifc;
 
+// Optional memory mapping of the image: reads become a copy from the page cache (shared by every emulator
+// instance booting the same image) instead of a syscall, and single sectors can be parsed in place.
+static const uint8_t*   s_map;
+static size_t           s_map_size;
+
+// Large reads hint the kernel to start reading the whole span ahead.
+static const intmax_t   kMapWillNeedSectors = 16;
+
+static void MediaUnmap() {
+#if HLE_FS_MMAP
+    if (s_map) {
+        munmap((void*)s_map, s_map_size);
+    }
+#endif
+    s_map = nullptr;
+    s_map_size = 0;
+}
+
+static void MediaMap() {
+#if HLE_FS_MMAP
+    struct stat st;
+    if (!s_mmap_enabled || fstat(s_fd, &st) != 0 || st.st_size <= 0) {
+        return;
+    }
+
+    auto* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, s_fd, 0);
+    if (map == MAP_FAILED) {
+        log_error("(psxfs) mmap failed, falling back on pread: %s", strerror(errno));
+        return;
+    }
+#   ifdef MADV_HUGEPAGE
+    madvise(map, st.st_size, MADV_HUGEPAGE);
+#   endif
+
+    s_map = (const uint8_t*)map;
+    s_map_size = st.st_size;
+#endif
+}
+
+static bool MediaIsMapped() {
+    return s_map != nullptr;
+}
+
+// Returns the data of a mapped sector, nullptr if the image isn't mapped (or the sector is out of it)
+static const uint8_t* MediaMapSector(psdisc_off_t sector) {
+    if (!s_map || sector >= s_media.num_sectors) return nullptr;
+
+    auto offset = sector * s_media.sector_size + s_media.offset_file_header + s_media.offset_sector_leadin;
+    if (offset + 2048 > (intmax_t)s_map_size) return nullptr;
+    return s_map + offset;
+}
+
+// Reads exactly count bytes: short reads are resumed, an error or an early end of file fails the read.
+static bool MediaPreadFull(void* dest, intmax_t count, intmax_t pos) {
+    auto* wptr = (uint8_t*)dest;
+    while (count > 0) {
+        auto res = s_ioifc.pread_cb(wptr, count, pos);
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (res <= 0) {
+            log_host("ERROR: ReadData2048(seekpos=%jd): %s", JFMT(pos), res ? strerror(errno) : "unexpected end of file");
+            return false;
+        }
+        wptr  += res;
+        pos   += res;
+        count -= res;
+    }
+    return true;
+}
+
 static bool ReadData2048(void* dest, psdisc_off_t sector, psdisc_off_t offset, psdisc_off_t length) {
     dbg_check(dest);
 
@@ -146,27 +723,62 @@ static bool ReadData2048(void* dest, psdisc_off_t sector, psdisc_off_t offset, p
     read_offset += s_media.offset_file_header;
     read_offset += s_media.offset_sector_leadin;      // data can skip the sync pattern, address, and mode info
 
+    auto map_span = (sec_read_count - 1) * s_media.sector_size + 2048;
+    if (s_map && read_offset + map_span <= (intmax_t)s_map_size) {
+        auto* rptr = s_map + read_offset;
+#if HLE_FS_MMAP
+        if (sec_read_count >= kMapWillNeedSectors) {
+            static const intptr_t kPageMask = 4095;
+            auto start = (intptr_t)rptr & ~kPageMask;
+            madvise((void*)start, (intptr_t)rptr + map_span - start, MADV_WILLNEED);
+        }
+#endif
+        if (s_media.sector_size == 2048) {
+            memcpy(dest, rptr, map_span);
+        }
+        else {
+            auto* wptr = (uint8_t*)dest;
+            for (intmax_t i = 0; i < sec_read_count; ++i, rptr += s_media.sector_size, wptr += 2048) {
+                memcpy(wptr, rptr, 2048);
+            }
+        }
+        return true;
+    }
+
     if (s_media.sector_size == 2048) {
         // optimized fastpath for ISO media.
-        auto res = s_ioifc.pread_cb(dest, s_media.sector_size * sec_read_count, read_offset);
-            if(!res) {
-                log_host("ERROR: ReadData2048(seekpos=%jd)", JFMT(read_offset));
-                return false;
-            }
+        if (!MediaPreadFull(dest, s_media.sector_size * sec_read_count, read_offset)) {
+            return false;
+        }
     }
     else {
+        // raw sectors (typically 2352 bytes BIN): read spans of sectors in one go and strip the sync, header
+        // and EDC/ECC regions while copying. The span ends on the data of its last sector.
+        // (thread_local: async reads may run concurrently)
+        static const intmax_t kBulkSectors = 64;
+        static thread_local std::vector<uint8_t> s_rawbuf;
+
         auto*   wptr = (uint8_t*)dest;
         auto    end_sector = sector + sec_read_count;
+        auto    sector_size = s_media.sector_size;
+
+        s_rawbuf.resize(kBulkSectors * sector_size);
 
-        for(;sector < end_sector; ++sector,
-            read_offset += s_media.sector_size,
-            wptr        += 2048
-        ) {
-            auto res = s_ioifc.pread_cb(wptr, 2048, read_offset);
-            if(!res) {
-                log_host("ERROR: ReadData2048(seekpos=%jd)", JFMT(read_offset));
+        while (sector < end_sector) {
+            auto count = std::min(kBulkSectors, end_sector - sector);
+            auto span  = (count - 1) * sector_size + 2048;
+
+            if (!MediaPreadFull(s_rawbuf.data(), span, read_offset)) {
                 return false;
             }
+
+            const uint8_t* rptr = s_rawbuf.data();
+            for (intmax_t i = 0; i < count; ++i, rptr += sector_size, wptr += 2048) {
+                memcpy(wptr, rptr, 2048);
+            }
+
+            sector      += count;
+            read_offset += count * sector_size;
         }
     }
 
@@ -176,191 +788,1891 @@ static bool ReadData2048(void* dest, psdisc_off_t sector, psdisc_off_t offset, p
 std::string s_curfilename;
 #endif
 
-void psxFs_CacheFilesystem() {
-    log_host("[HLEBIOS] psxFs_CacheFilesystem");
-#if HLE_PCSX_IFC
-    auto filename = GetIsoFile();
-
-    if (s_fd >= 0) {
-        if (strcasecmp(filename, s_curfilename.c_str()) == 0) {
-            return;
-        }
-        posix_close(s_fd);
-    }
-    s_curfilename = filename;
-    log_host("(psxhle) caching iso filesystem: %s", filename);
+static void SectorCacheInvalidate();
+void psxFs_DrainReads();
+static bool ReadSectorsUncached(void* dest, psdisc_sec_t sector, int nSectors);
+static void BootProfileBegin(uint64_t fingerprint);
+static void BootProfileEnd();
+static void BootProfileOnDemand(psdisc_sec_t sector, int count);
+
+// Startup report (HleGetStartupReport): bytes read from the media by the HLE, and timings of the index of the
+// current disc. The parse covers the directory walk (or the index cache load), the LUT build the path table
+// and the sector extents.
+static std::atomic<uint64_t> s_media_bytes_read;
+static std::atomic<uint64_t> s_index_parse_us;
+static std::atomic<uint64_t> s_index_lut_us;
+static std::atomic<uint64_t> s_index_io_bytes;
+
+uint64_t psxFs_GetMediaBytesRead() {
+    return s_media_bytes_read;
+}
 
-    s_fd = posix_open(filename, O_RDONLY, DEFFILEMODE);
-    if (s_fd < 0) {
-        log_error("%s: %s", strerror(errno), filename);
-        dbg_abort();
-    }
+void psxFs_GetIndexTimings(uint64_t& parse_us, uint64_t& lut_us, uint64_t& io_bytes) {
+    parse_us = s_index_parse_us;
+    lut_us   = s_index_lut_us;
+    io_bytes = s_index_io_bytes;
+}
 
-    s_ioifc = {
-        // pread
-        [&](void* dest, intmax_t count, intmax_t pos) {
-            dbg_check(s_fd >= 0);
-            return posix_pread(s_fd, dest, count, pos);
-        }
-    };
+// --------------------------------------------------------------------------------------
+// Index builder
+//
+// The ISO9660 directory tree is indexed lazily: psxFs_CacheFilesystem only parses the root directory, and
+// a subdirectory is parsed the first time a path beneath it is looked up (on the calling thread, unless a
+// background thread is already at it). Files are added to a partial path table as their directory is
+// parsed, each path being built from the path of its parent.
+//
+// Meanwhile, the rest of the tree is walked by background threads (several ones when the backend reads
+// concurrently, ie. PCSX) to complete the index, which is then published by the emulation thread
+// (IndexPoll): lookups by sector, the index cache and the index LRU need the complete tree.
+
+enum : uint8_t
+{
+    kDirUnparsed,
+    kDirParsing,
+    kDirParsed,
+};
 
-    if (!DiscFS_DetectMediaDescription(s_media, s_fd)) {
-        log_error("Could not parse contents of file: %s", filename);
-        dbg_abort();
-    }
-#endif
+struct IndexBuildDir
+{
+    uint32_t        file_id;
+    psdisc_sec_t    sector;
+    uint32_t        len_bytes;
+    std::string     path;               // lookup key, empty for the root
+};
 
-#if HLE_MEDNAFEN_IFC
-    auto cdif = GetCurrentCDIF();
+struct IndexBuildRecord
+{
+    psdisc_sec_t    sector;
+    uint32_t        len_bytes;
+    int             type;
+    std::string     name;
+};
 
-    // pointer comparison, not my ideal choice, but the cdif doesn't give us much internal data from
-    // which to further identify the media from another media.
-    if (cdif == s_cur_cdif) {
-        return;
+struct IndexBuilder
+{
+    std::mutex                  mutex;
+    std::condition_variable     work_cv;        // directory queued, or walk complete
+    std::condition_variable     progress_cv;    // directory parsed, or walk complete
+    std::thread                 thread;
+    std::deque<IndexBuildDir>   queue;          // may contain directories already parsed on demand
+    int                         busy;           // directories being parsed
+    bool                        running;        // emulation thread only
+    bool                        cancel;
+    bool                        done;
+
+    std::shared_ptr<DiscIndex>                      build;
+    std::unordered_map<std::string, uint32_t>       paths;          // lookup key -> file id
+    std::unordered_map<psdisc_off_t, uint32_t>      filesByStart;
+    std::vector<uint8_t>                            dirState;       // by file id
+    DiscIndexPtr                                    result;
+    PSX_BOOT_INFO                                   boot;           // SYSTEM.CNF, stored along with the index
+    bool                                            boot_stored;    // the index cache has the boot info
+    std::chrono::steady_clock::time_point           start;
+
+    ~IndexBuilder() {
+        if (thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                cancel = true;
+            }
+            work_cv.notify_all();
+            thread.join();
+        }
     }
-    s_cur_cdif = cdif;
-#endif
+};
 
-#if HLE_DUCKSTATION_IFC
-    auto fullpath = System::GetRunningPath();
-    if (fullpath.empty()) {
-        log_error( "(psxfs) psxFs_CacheFilesystem: empty path");
-        return;
-    }
-    if (fullpath == s_iso_path)
-        return;
+static IndexBuilder s_builder;
 
-    s_iso_path = fullpath;
-    ds_cdimage = CDImage::Open(fullpath.c_str(), nullptr);
+#if HLE_PCSX_IFC
+static int s_index_threads = 4;
+#else
+static int s_index_threads = 1;             // the backend serializes reads anyway
 #endif
 
-    m_filesBySector   .clear();
-    m_dirsBySector    .clear();
-    m_filesByFullpath .clear();
+extern "C" void HleSetFsIndexThreads(int count) {
+    // 0 only parses the directories looked up (the index is never completed). On Mednafen any other
+    // count walks the whole disc synchronously.
+    s_index_threads = std::max(count, 0);
+}
 
-    m_dirsBySector.insert({0, fs::path()});
+static inline uint32_t IsoLoad32LE(const uint8_t* src) {
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
 
-    PsDiscDirParser parser;
-#if HLE_PCSX_IFC
-    parser.read_data_cb = ReadData2048;
-#elif HLE_MEDNAFEN_IFC
-    parser.read_data_cb = [&](uint8_t* dest, psdisc_off_t sector, psdisc_off_t offset, psdisc_off_t length) {
-        dbg_check(offset == 0);
-        return s_cur_cdif->ReadSector(dest, sector, (length + 2047) / 2048) != 0;
+// Reads sectors of a media other than the current one (see psxFs_PrefetchPlaylist)
+using IndexSectorReader = std::function<bool(void* dest, psdisc_sec_t sector, int nSectors)>;
+
+// ECMA-119 9.1: directory records never cross a sector boundary, the remainder of a sector is zero-filled.
+static bool IndexReadDirectory(const IndexBuildDir& dir, std::vector<uint8_t>& buf, std::vector<IndexBuildRecord>& dest,
+    const IndexSectorReader* reader = nullptr)
+{
+    // Tomb Raider 2 got strange sector, maybe a copy-protection. Skip the directory to
+    // allow booting the game
+    if (!dir.len_bytes) {
+        log_error("(psxfs) invalid directory length, skip sector %jd", JFMT(dir.sector));
+        return false;
+    }
+
+    auto nSectors = (int)((dir.len_bytes + 2047) / 2048);
+    buf.resize(nSectors * 2048);
+    if (!reader) {
+        s_index_io_bytes += nSectors * 2048;
+    }
+    if (!(reader ? (*reader)(buf.data(), dir.sector, nSectors) : ReadSectorsUncached(buf.data(), dir.sector, nSectors))) {
+        log_error("(psxfs) failed to read directory at sector %jd", JFMT(dir.sector));
+        return false;
+    }
+
+    for (int i = 0; i < nSectors; ++i) {
+        auto* sec = buf.data() + i * 2048;
+        for (int pos = 0; pos < 2048; ) {
+            auto* rec = sec + pos;
+            int reclen = rec[0];
+            if (reclen < 34 || pos + reclen > 2048) {
+                break;
+            }
+            pos += reclen;
+
+            int nameLen = rec[32];
+            if (33 + nameLen > reclen) {
+                continue;
+            }
+            // self and parent entries
+            if (nameLen == 1 && rec[33] <= 1) {
+                continue;
+            }
+            dbg_check( nameLen <= kPsDiscMaxFileNameLength );
+
+            IndexBuildRecord entry;
+            entry.sector    = IsoLoad32LE(rec + 2);
+            entry.len_bytes = IsoLoad32LE(rec + 10);
+            entry.type      = (rec[25] & 2) ? FILETYPE_DIR : FILETYPE_FILE;
+            entry.name.assign((const char*)rec + 33, nameLen);
+            dest.push_back(std::move(entry));
+        }
+    }
+    return true;
+}
+
+// Adds the entries of a directory to the index being built. Must be called with the builder lock held.
+static void IndexAddFile(IndexBuilder& b, const IndexBuildRecord& rec, psdisc_sec_t parent, const std::string& parent_path) {
+    if (g_bVerbose) {
+        log_error( "(psxfs) AddFile [parent=%-6jd sector=%-6jd len=%-10u]: %s",
+            JFMT(parent), JFMT(rec.sector), rec.len_bytes, rec.name.c_str()
+        );
+    }
+
+    if (b.filesByStart.count(rec.sector)) {
+        log_error("(psxfs) Suspicious duplicate encountered [parent=%-6jd sector=%-6jd len=%-10u]: %s",
+            JFMT(parent), JFMT(rec.sector), rec.len_bytes, rec.name.c_str()
+        );
+
+        return;
+    }
+
+    // strip the ECMA-119 semicolon revision info.
+    auto nameLen = rec.name.size();
+    if (nameLen >= 2 && rec.name[nameLen-2] == ';') {
+        nameLen -= 2;
+    }
+
+    auto& idx = *b.build;
+    fileEnt_t fe = {};
+
+    fe.start_sector     = rec.sector;
+    fe.parent_sector    = parent;
+    fe.len_bytes        = rec.len_bytes;
+    fe.type             = rec.type;
+    fe.name_offset      = (uint32_t)idx.namePool.size();
+    idx.namePool.insert(idx.namePool.end(), rec.name.begin(), rec.name.begin() + nameLen);
+    idx.namePool.push_back(0);
+
+    auto id = (uint32_t)idx.files.size();
+    idx.files.push_back(fe);
+    b.dirState.push_back(kDirUnparsed);
+    b.filesByStart.insert({rec.sector, id});
+
+    auto seclen = (rec.len_bytes + 2047) / 2048;
+    if (seclen) {
+        idx.extents.push_back({ rec.sector, (uint32_t)seclen, id });
+    }
+
+    auto path = parent_path;
+    if (nameLen) {
+        if (!path.empty()) path += '/';
+        for (size_t i = 0; i < nameLen; ++i) {
+            path += PathKeyChar(rec.name[i]);
+        }
+    }
+    b.paths.insert({path, id});
+
+    if (rec.type == FILETYPE_DIR) {
+        b.queue.push_back({ id, rec.sector, rec.len_bytes, std::move(path) });
+        b.work_cv.notify_one();
+    }
+}
+
+// Parses a directory once, either on demand or from the background walk. The builder lock is released
+// while the directory is read.
+static void IndexParseDirectory(std::unique_lock<std::mutex>& lock, const IndexBuildDir& dir) {
+    static thread_local std::vector<uint8_t> s_dirbuf;
+    static thread_local std::vector<IndexBuildRecord> s_records;
+
+    auto& b = s_builder;
+    dbg_check(b.dirState[dir.file_id] == kDirUnparsed);
+    b.dirState[dir.file_id] = kDirParsing;
+    ++b.busy;
+    lock.unlock();
+
+    s_records.clear();
+    IndexReadDirectory(dir, s_dirbuf, s_records);
+
+    lock.lock();
+    auto first = (uint32_t)b.build->files.size();
+    for (auto& rec : s_records) {
+        IndexAddFile(b, rec, dir.sector, dir.path);
+    }
+    b.build->children[dir.sector] = { first, (uint32_t)b.build->files.size() };
+    b.dirState[dir.file_id] = kDirParsed;
+    if (!--b.busy) {
+        b.work_cv.notify_all();
+    }
+    b.progress_cv.notify_all();
+}
+
+static void IndexBuildWorker() {
+    auto& b = s_builder;
+
+    std::unique_lock<std::mutex> lock(b.mutex);
+    for (;;) {
+        b.work_cv.wait(lock, [&]{ return b.cancel || !b.queue.empty() || !b.busy; });
+        if (b.cancel || b.queue.empty()) {
+            // nothing queued and nobody parsing: the walk is complete
+            b.work_cv.notify_all();
+            return;
+        }
+
+        auto dir = std::move(b.queue.front());
+        b.queue.pop_front();
+        if (b.dirState[dir.file_id] == kDirUnparsed) {
+            IndexParseDirectory(lock, dir);
+        }
+    }
+}
+
+static void IndexBuildMain(int nthreads) {
+    auto& b = s_builder;
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < nthreads; ++i) {
+        helpers.emplace_back(IndexBuildWorker);
+    }
+    IndexBuildWorker();
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+
+    // The tables are built and the cache written without the lock, so that the emulation thread lookups
+    // aren't stalled. The walk is complete: they only read the tables (files, paths) the new ones are built
+    // from. A boot info set meanwhile is stored by IndexPoll.
+    bool cancel;
+    PSX_BOOT_INFO boot;
+    {
+        std::lock_guard<std::mutex> lock(b.mutex);
+        cancel = b.cancel;
+        boot   = b.boot;
+    }
+
+    DiscIndexPtr result;
+    bool stored = false;
+    if (!cancel) {
+        auto walked = std::chrono::steady_clock::now();
+        s_index_parse_us = std::chrono::duration_cast<std::chrono::microseconds>(walked - b.start).count();
+
+        BuildPathSlots(*b.build, b.paths);
+        BuildExtents(*b.build);
+        s_index_lut_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - walked).count();
+        IndexCacheStore(*b.build, boot);
+        stored = boot.valid;
+        result = DiscIndexIntern(b.build, boot);
+    }
+
+    std::lock_guard<std::mutex> lock(b.mutex);
+    b.result = std::move(result);
+    if (!b.boot.valid) {
+        // maybe known from an earlier run of the disc
+        b.boot = boot;
+    }
+    b.boot_stored = stored;
+    b.done = true;
+    b.progress_cv.notify_all();
+}
+
+static void IndexBuildReset() {
+    auto& b = s_builder;
+    if (b.thread.joinable()) {
+        b.thread.join();
+    }
+    b.queue.clear();
+    b.busy      = 0;
+    b.running   = false;
+    b.cancel    = false;
+    b.done      = false;
+    b.build.reset();
+    b.paths.clear();
+    b.filesByStart.clear();
+    b.dirState.clear();
+    b.result.reset();
+    b.boot = {};
+    b.boot_stored = false;
+}
+
+static void IndexBuildCancel() {
+    auto& b = s_builder;
+    if (!b.running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(b.mutex);
+        b.cancel = true;
+    }
+    b.work_cv.notify_all();
+    IndexBuildReset();
+}
+
+static void IndexBuildStart(psdisc_sec_t root_sector, uint32_t root_len, uint64_t fingerprint) {
+    auto& b = s_builder;
+    IndexBuildReset();
+
+    b.build = std::make_shared<DiscIndex>();
+    b.build->fingerprint    = fingerprint;
+    b.build->media_sectors  = s_media_sectors;
+    b.running = true;
+    b.start   = std::chrono::steady_clock::now();
+
+    // the root directory is parsed right away, SYSTEM.CNF is looked up next.
+    {
+        std::unique_lock<std::mutex> lock(b.mutex);
+        IndexAddFile(b, { root_sector, root_len, FILETYPE_DIR, {} }, 0, {});
+        auto root = std::move(b.queue.front());
+        b.queue.pop_front();
+        IndexParseDirectory(lock, root);
+    }
+
+    if (s_index_threads) {
+#if HLE_MEDNAFEN_IFC
+        // The CDIF is the emulator's own, shared with its CD-ROM controller: it can't be read from another
+        // thread, the walk runs on the emulation thread.
+        IndexBuildMain(1);
+#else
+        b.thread = std::thread(IndexBuildMain, s_index_threads);
+#endif
+    }
+}
+
+// Publishes the index once the walk is complete. Emulation thread only.
+static void IndexPoll(bool wait) {
+    auto& b = s_builder;
+    if (s_index || !b.running) return;
+
+    std::unique_lock<std::mutex> lock(b.mutex);
+    if (wait) {
+        b.progress_cv.wait(lock, [&]{ return b.done; });
+    }
+    if (!b.done) return;
+
+    auto result = std::move(b.result);
+    auto boot   = b.boot;
+    bool stored = b.boot_stored;
+    lock.unlock();
+
+    IndexBuildReset();
+    s_index = std::move(result);
+    if (!s_boot_info.valid) {
+        s_boot_info = boot;
+    }
+    if (s_index && s_boot_info.valid && !stored) {
+        // set while the index was being stored
+        DiscIndexSetBoot(s_index->fingerprint, s_boot_info);
+        IndexCacheStore(*s_index, s_boot_info);
+    }
+}
+
+// Parses the directories leading to a path in the partial index as needed, and the path itself when
+// it's a directory being listed. Must be called with the builder lock held.
+static bool IndexParsePath(std::unique_lock<std::mutex>& lock, const std::string& key, bool listing) {
+    auto& b = s_builder;
+
+    // every parent directory, from the root (empty key)
+    size_t dirlen = 0;
+    for (;;) {
+        auto dirkey = key.substr(0, dirlen);
+        auto it = b.paths.find(dirkey);
+        if (it == b.paths.end() || b.build->files[it->second].type != FILETYPE_DIR) {
+            return false;
+        }
+        auto id = it->second;
+        while (b.dirState[id] == kDirParsing) {
+            b.progress_cv.wait(lock);
+        }
+        if (b.dirState[id] == kDirUnparsed) {
+            auto& fe = b.build->files[id];
+            IndexParseDirectory(lock, { id, fe.start_sector, (uint32_t)fe.len_bytes, dirkey });
+        }
+
+        if (dirlen == key.size()) break;
+        auto sep = key.find('/', dirlen ? dirlen + 1 : 0);
+        if (sep == std::string::npos) {
+            if (!listing || key.empty()) break;
+            sep = key.size();
+        }
+        dirlen = sep;
+    }
+    return true;
+}
+
+// Looks up a path in the partial index, parsing the directories leading to it as needed.
+static bool IndexFindPartial(const std::string& key, fileEnt_t& dest) {
+    auto& b = s_builder;
+    std::unique_lock<std::mutex> lock(b.mutex);
+
+    if (!IndexParsePath(lock, key, false)) {
+        return false;
+    }
+
+    auto it = b.paths.find(key);
+    if (it == b.paths.end()) {
+        return false;
+    }
+    dest = b.build->files[it->second];
+    return true;
+}
+
+// Looks up a path, waiting only for the directories leading to it.
+static bool psxFs_FindFile(const char* path, fileEnt_t& dest) {
+    if (!path) return false;
+
+    IndexPoll(false);
+    if (!s_index && s_builder.running) {
+        return IndexFindPartial(PathKeyString(path), dest);
+    }
+
+    if (auto* fe = s_index ? s_index->FindFile(path) : nullptr) {
+        dest = *fe;
+        return true;
+    }
+    return false;
+}
+
+// Doesn't wait for the index: returns nullptr until it's published.
+const fileEnt_t* psxFs_FindFileBySector(psdisc_sec_t sector) {
+    IndexPoll(false);
+    return s_index ? s_index->FindFileBySector(sector) : nullptr;
+}
+
+// Returns false if SYSTEM.CNF hasn't been parsed yet for the current disc.
+bool psxFs_GetBootInfo(PSX_BOOT_INFO& dest) {
+    IndexPoll(false);
+    if (!s_boot_info.valid) return false;
+    dest = s_boot_info;
+    return true;
+}
+
+void psxFs_SetBootInfo(const PSX_BOOT_INFO& src) {
+    auto& b = s_builder;
+    s_boot_info = src;
+    s_boot_info.valid = 1;
+
+    IndexPoll(false);
+    if (!s_index && b.running) {
+        // still walking the directories: stored along with the index
+        std::lock_guard<std::mutex> lock(b.mutex);
+        if (!b.done) {
+            b.boot = s_boot_info;
+            return;
+        }
+    }
+    IndexPoll(true);
+    if (!s_index) return;
+
+    DiscIndexSetBoot(s_index->fingerprint, s_boot_info);
+    IndexCacheStore(*s_index, s_boot_info);
+}
+
+// Media generation: bumped by psxFs_OnMediaChanged when the emulator inserts or swaps a disc. Sector reads
+// only compare it against the generation the index was built for, instead of re-identifying the media.
+static uint32_t s_media_generation   = 1;
+static uint32_t s_indexed_generation = 0;
+
+uint32_t psxFs_GetMediaGeneration() {
+    return s_media_generation;
+}
+
+// Identifies the current media and rebuilds the index if it changed. The media identity check is skipped
+// (and the index rebuilt unconditionally) once the media generation has been bumped.
+void psxFs_CacheFilesystem() {
+    bool changed = (s_indexed_generation != s_media_generation);
+
+#if HLE_PCSX_IFC
+    auto filename = GetIsoFile();
+
+    if (s_fd >= 0) {
+        if (!changed && strcasecmp(filename, s_curfilename.c_str()) == 0) {
+            return;
+        }
+        psxFs_DrainReads();
+        IndexBuildCancel();
+        MediaUnmap();
+        posix_close(s_fd);
+    }
+    s_curfilename = filename;
+    log_host("(psxhle) caching iso filesystem: %s", filename);
+
+    s_fd = posix_open(filename, O_RDONLY, DEFFILEMODE);
+    if (s_fd < 0) {
+        log_error("%s: %s", strerror(errno), filename);
+        dbg_abort();
+    }
+
+    s_ioifc = {
+        // pread
+        [&](void* dest, intmax_t count, intmax_t pos) {
+            dbg_check(s_fd >= 0);
+            return posix_pread(s_fd, dest, count, pos);
+        }
+    };
+
+    if (!DiscFS_DetectMediaDescription(s_media, s_fd)) {
+        log_error("Could not parse contents of file: %s", filename);
+        dbg_abort();
+    }
+
+    MediaMap();
+#endif
+
+#if HLE_MEDNAFEN_IFC
+    auto cdif = GetCurrentCDIF();
+
+    // pointer comparison, not my ideal choice, but the cdif doesn't give us much internal data from
+    // which to further identify the media from another media.
+    if (!changed && cdif == s_cur_cdif) {
+        return;
+    }
+    psxFs_DrainReads();
+    IndexBuildCancel();
+    s_cur_cdif = cdif;
+#endif
+
+#if HLE_DUCKSTATION_IFC
+    auto fullpath = System::GetRunningPath();
+    if (fullpath.empty()) {
+        log_error( "(psxfs) psxFs_CacheFilesystem: empty path");
+        return;
+    }
+    if (!changed && fullpath == s_iso_path)
+        return;
+
+    psxFs_DrainReads();
+    IndexBuildCancel();
+    s_iso_path = fullpath;
+    ds_cdimage = CDImage::Open(fullpath.c_str(), nullptr);
+#endif
+
+    log_host("[HLEBIOS] psxFs_CacheFilesystem");
+    s_indexed_generation = s_media_generation;
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed_us = [&] {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
     };
+    s_index_parse_us = 0;
+    s_index_lut_us   = 0;
+    s_index_io_bytes = 0;
+
+    BootProfileEnd();
+    s_index.reset();
+    s_boot_info = {};
+    SectorCacheInvalidate();
+
+#if HLE_PCSX_IFC
+    s_media_sectors = s_media.num_sectors;
+#elif HLE_DUCKSTATION_IFC
+    s_media_sectors = ds_cdimage->GetLBACount();
+#else
+    // The CDIF doesn't expose the media size, the PVD volume space size stands for it.
+    s_media_sectors = 0;
+#endif
+
+    // Primary volume descriptor (ISO9660 sector 16)
+    // Not an ISO9660 media if it can't be read, not worth caching nor sharing.
+    uint8_t pvd[2048];
+    if (!ReadSectorsUncached(pvd, 16, 1) || pvd[0] != 1 || memcmp(pvd + 1, "CD001", 5) != 0) {
+        log_error("(psxfs) no ISO9660 filesystem found");
+        s_index = std::make_shared<DiscIndex>();
+        return;
+    }
+
+    uint64_t fingerprint = FingerprintHash(14695981039346656037ull, pvd, sizeof(pvd));
+    fingerprint = FingerprintHash(fingerprint, &s_media_sectors, sizeof(s_media_sectors));
+    BootProfileBegin(fingerprint);
+
+    if ((s_index = DiscIndexLookup(fingerprint, s_boot_info))) {
+        log_host("(psxfs) reusing the index of disc %016llx", (unsigned long long)fingerprint);
+        s_index_parse_us = elapsed_us();
+        return;
+    }
+    if (auto idx = IndexCacheLoad(fingerprint, s_media_sectors, s_boot_info)) {
+        s_index = DiscIndexIntern(std::move(idx), s_boot_info);
+        s_index_parse_us = elapsed_us();
+        return;
+    }
+
+    // root directory record (ECMA-119 8.4.18)
+    IndexBuildStart(IsoLoad32LE(pvd + 156 + 2), IsoLoad32LE(pvd + 156 + 10), fingerprint);
+    IndexPoll(false);
+}
+
+extern "C" void psxFs_OnMediaChanged() {
+    ++s_media_generation;
+    psxFs_CacheFilesystem();
+}
+
+// --------------------------------------------------------------------------------------
+// Playlist prefetch
+//
+// The indexes of the discs of a playlist (.m3u) are loaded from the index cache, or built, by a background
+// thread at startup. The LRU keeps them, so that the first swap to another disc finds its index interned
+// already. Only the backends which can open an image on their own support it (PCSX, DuckStation).
+
+struct PlaylistPrefetch
+{
+    std::thread             thread;
+    std::atomic<bool>       cancel { false };
+
+    void Stop() {
+        cancel = true;
+        if (thread.joinable()) {
+            thread.join();
+        }
+        cancel = false;
+    }
+
+    ~PlaylistPrefetch() {
+        Stop();
+    }
+};
+
+static PlaylistPrefetch s_playlist_prefetch;
+
+// Walks the whole directory tree of an image on the calling thread, with a private builder.
+static DiscIndexPtr IndexBuildImage(const IndexSectorReader& reader, uint64_t media_sectors) {
+    uint8_t pvd[2048];
+    if (!reader(pvd, 16, 1) || pvd[0] != 1 || memcmp(pvd + 1, "CD001", 5) != 0) {
+        return nullptr;
+    }
+
+    uint64_t fingerprint = FingerprintHash(14695981039346656037ull, pvd, sizeof(pvd));
+    fingerprint = FingerprintHash(fingerprint, &media_sectors, sizeof(media_sectors));
+
+    PSX_BOOT_INFO boot = {};
+    if (auto idx = DiscIndexLookup(fingerprint, boot)) {
+        return idx;
+    }
+    if (auto idx = IndexCacheLoad(fingerprint, media_sectors, boot)) {
+        return DiscIndexIntern(std::move(idx), boot);
+    }
+
+    IndexBuilder b;
+    b.build = std::make_shared<DiscIndex>();
+    b.build->fingerprint    = fingerprint;
+    b.build->media_sectors  = media_sectors;
+    IndexAddFile(b, { IsoLoad32LE(pvd + 156 + 2), IsoLoad32LE(pvd + 156 + 10), FILETYPE_DIR, {} }, 0, {});
+
+    std::vector<uint8_t> buf;
+    std::vector<IndexBuildRecord> records;
+    while (!b.queue.empty()) {
+        if (s_playlist_prefetch.cancel) {
+            return nullptr;
+        }
+        auto dir = std::move(b.queue.front());
+        b.queue.pop_front();
+
+        records.clear();
+        IndexReadDirectory(dir, buf, records, &reader);
+        auto first = (uint32_t)b.build->files.size();
+        for (auto& rec : records) {
+            IndexAddFile(b, rec, dir.sector, dir.path);
+        }
+        b.build->children[dir.sector] = { first, (uint32_t)b.build->files.size() };
+    }
+
+    BuildPathSlots(*b.build, b.paths);
+    BuildExtents(*b.build);
+    IndexCacheStore(*b.build, boot);
+    return DiscIndexIntern(b.build, boot);
+}
+
+static void PrefetchImage(const std::string& path) {
+    DiscIndexPtr idx;
+
+#if HLE_PCSX_IFC
+    int fd = posix_open(path.c_str(), O_RDONLY, DEFFILEMODE);
+    if (fd < 0) {
+        log_error("(psxfs) playlist: %s: %s", strerror(errno), path.c_str());
+        return;
+    }
+
+    MediaSourceDescriptor media;
+    if (DiscFS_DetectMediaDescription(media, fd)) {
+        idx = IndexBuildImage([&](void* dest, psdisc_sec_t sector, int nSectors) {
+            if (sector + nSectors > media.num_sectors) return false;
+            auto* wptr = (uint8_t*)dest;
+            for (int i = 0; i < nSectors; ++i, wptr += 2048) {
+                auto pos = (sector + i) * media.sector_size + media.offset_file_header + media.offset_sector_leadin;
+                if (posix_pread(fd, wptr, 2048, pos) != 2048) return false;
+            }
+            return true;
+        }, media.num_sectors);
+    }
+    else {
+        log_error("(psxfs) playlist: could not parse contents of file: %s", path.c_str());
+    }
+    posix_close(fd);
 #elif HLE_DUCKSTATION_IFC
-    parser.read_data_cb = [&](uint8_t* dest, psdisc_off_t sector, psdisc_off_t offset, psdisc_off_t length) {
-        // Tomb Raider 2 got strange sector, maybe a copy-protection. Skip the sector to
-        // allow booting the game
-        if (length == 0) {
-            log_error( "(psxfs) psxFs_CacheFilesystem: invalid length, skip sector");
+    auto image = CDImage::Open(path.c_str(), nullptr);
+    if (!image) {
+        log_error("(psxfs) playlist: can't open %s", path.c_str());
+        return;
+    }
+
+    idx = IndexBuildImage([&](void* dest, psdisc_sec_t sector, int nSectors) {
+        image->Seek(1, sector);
+        return image->Read(CDImage::ReadMode::DataOnly, nSectors, dest) == (uint32_t)nSectors;
+    }, image->GetLBACount());
+#else
+    log_host("(psxfs) playlist prefetch isn't supported by this backend: %s", path.c_str());
+#endif
+
+    if (idx) {
+        log_host("(psxfs) playlist: indexed %s (disc %016llx)", path.c_str(), (unsigned long long)idx->fingerprint);
+    }
+}
+
+extern "C" void HleFsPrefetchPlaylist(const char* m3u_path) {
+    s_playlist_prefetch.Stop();
+
+    auto* fp = m3u_path ? fopen(m3u_path, "rb") : nullptr;
+    if (!fp) {
+        log_error("(psxfs) can't open playlist %s", m3u_path ? m3u_path : "(null)");
+        return;
+    }
+
+    // entries are relative to the playlist directory
+    std::string base(m3u_path);
+    auto sep = base.find_last_of("/\\");
+    base = (sep == std::string::npos) ? std::string() : base.substr(0, sep + 1);
+
+    std::vector<std::string> images;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp)) {
+        std::string entry(line);
+        while (!entry.empty() && (entry.back() == '\n' || entry.back() == '\r' || entry.back() == ' ')) {
+            entry.pop_back();
+        }
+        if (entry.empty() || entry[0] == '#') continue;
+
+        bool absolute = entry[0] == '/' || entry[0] == '\\' || (entry.size() > 1 && entry[1] == ':');
+        images.push_back(absolute ? entry : base + entry);
+    }
+    fclose(fp);
+
+    s_playlist_prefetch.thread = std::thread([images = std::move(images)] {
+        for (auto& image : images) {
+            if (s_playlist_prefetch.cancel) break;
+            PrefetchImage(image);
+        }
+    });
+}
+
+// Serializes the media backends, which aren't reentrant (CDImage::Seek+Read pairs, CDIF). PCSX reads are
+// plain pread calls and don't need it.
+static std::mutex s_backend_mutex;
+
+static bool ReadSectorsUncached(void* dest, psdisc_sec_t sector, int nSectors) {
+    s_media_bytes_read += nSectors * 2048;
+#if HLE_PCSX_IFC
+    return ReadData2048(dest, sector, 0, nSectors * 2048);
+#else
+    std::lock_guard<std::mutex> lock(s_backend_mutex);
+#endif
+#if HLE_MEDNAFEN_IFC
+    return s_cur_cdif->ReadSector((uint8_t*)dest, sector, nSectors) != 0;
+#endif
+
+#if HLE_DUCKSTATION_IFC
+    ds_cdimage->Seek(1, sector);
+
+    auto secread = ds_cdimage->Read(CDImage::ReadMode::DataOnly, nSectors, dest);
+    return (secread == nSectors);
+#endif
+
+}
+
+// --------------------------------------------------------------------------------------
+// Sector cache
+//
+// LRU cache of 2048-byte data sectors for HLE disc reads (exe/overlay loads, SYSTEM.CNF), so that games
+// reloading the same overlays are served from memory. Misses are read from the media in runs, extended by
+// a readahead window which doubles on each sequential read and drops to zero on a seek.
+// The cache is flushed when the filesystem index is rebuilt (media change).
+
+struct SectorCacheStats
+{
+    uint64_t    hits;
+    uint64_t    misses;
+    uint64_t    readahead;          // sectors read ahead of the request
+    uint64_t    bypass;             // sectors of reads too large for the cache
+    uint64_t    prefetch;           // sectors prefetched for the emulator CD path
+};
+
+static const uint32_t kSectorCacheNil           = UINT32_MAX;
+static const uint32_t kReadaheadMinSectors      = 4;
+static const uint32_t kReadaheadMaxSectors      = 64;
+
+static uint32_t                                     s_sector_cache_capacity = 1024;     // 2MB
+static std::vector<uint8_t>                         s_sector_cache_data;
+static std::vector<psdisc_sec_t>                    s_sector_cache_sector;
+static std::vector<uint32_t>                        s_sector_cache_prev;
+static std::vector<uint32_t>                        s_sector_cache_next;
+static std::unordered_map<psdisc_sec_t, uint32_t>   s_sector_cache_map;
+static uint32_t                                     s_sector_cache_used;
+static uint32_t                                     s_sector_cache_head = kSectorCacheNil;     // most recently used
+static uint32_t                                     s_sector_cache_tail = kSectorCacheNil;     // least recently used
+static psdisc_sec_t                                 s_readahead_next;
+static uint32_t                                     s_readahead_window;
+static SectorCacheStats                             s_sector_cache_stats;
+static std::mutex                                   s_sector_cache_mutex;   // guards all of the above
+
+extern "C" void HleSetFsSectorCacheSize(uint32_t sectors) {
+    std::lock_guard<std::mutex> lock(s_sector_cache_mutex);
+    s_sector_cache_capacity = sectors;
+    SectorCacheInvalidate();
+}
+
+// Caller holds s_sector_cache_mutex, or no read is in flight.
+static void SectorCacheInvalidate() {
+    s_sector_cache_data     .clear();
+    s_sector_cache_sector   .clear();
+    s_sector_cache_prev     .clear();
+    s_sector_cache_next     .clear();
+    s_sector_cache_map      .clear();
+    s_sector_cache_used     = 0;
+    s_sector_cache_head     = kSectorCacheNil;
+    s_sector_cache_tail     = kSectorCacheNil;
+    s_readahead_next        = 0;
+    s_readahead_window      = 0;
+}
+
+static void SectorCacheUnlink(uint32_t slot) {
+    auto prev = s_sector_cache_prev[slot];
+    auto next = s_sector_cache_next[slot];
+    if (prev != kSectorCacheNil) s_sector_cache_next[prev] = next; else s_sector_cache_head = next;
+    if (next != kSectorCacheNil) s_sector_cache_prev[next] = prev; else s_sector_cache_tail = prev;
+}
+
+static void SectorCacheLinkHead(uint32_t slot) {
+    s_sector_cache_prev[slot] = kSectorCacheNil;
+    s_sector_cache_next[slot] = s_sector_cache_head;
+    if (s_sector_cache_head != kSectorCacheNil) s_sector_cache_prev[s_sector_cache_head] = slot;
+    s_sector_cache_head = slot;
+    if (s_sector_cache_tail == kSectorCacheNil) s_sector_cache_tail = slot;
+}
+
+static const uint8_t* SectorCacheLookup(psdisc_sec_t sector) {
+    auto it = s_sector_cache_map.find(sector);
+    if (it == s_sector_cache_map.end()) {
+        return nullptr;
+    }
+    auto slot = it->second;
+    SectorCacheUnlink(slot);
+    SectorCacheLinkHead(slot);
+    return s_sector_cache_data.data() + slot * 2048ull;
+}
+
+static void SectorCacheInsert(psdisc_sec_t sector, const uint8_t* src) {
+    // the cache may have been disabled while the sectors were read (the lock isn't held during the read)
+    if (!s_sector_cache_capacity) {
+        return;
+    }
+    if (s_sector_cache_data.empty()) {
+        s_sector_cache_data     .resize(s_sector_cache_capacity * 2048ull);
+        s_sector_cache_sector   .resize(s_sector_cache_capacity);
+        s_sector_cache_prev     .resize(s_sector_cache_capacity);
+        s_sector_cache_next     .resize(s_sector_cache_capacity);
+    }
+
+    uint32_t slot;
+    if (auto it = s_sector_cache_map.find(sector); it != s_sector_cache_map.end()) {
+        slot = it->second;
+        SectorCacheUnlink(slot);
+    }
+    else if (s_sector_cache_used < s_sector_cache_capacity) {
+        slot = s_sector_cache_used++;
+        s_sector_cache_map.insert({sector, slot});
+    }
+    else {
+        slot = s_sector_cache_tail;
+        SectorCacheUnlink(slot);
+        s_sector_cache_map.erase(s_sector_cache_sector[slot]);
+        s_sector_cache_map.insert({sector, slot});
+    }
+
+    s_sector_cache_sector[slot] = sector;
+    memcpy(s_sector_cache_data.data() + slot * 2048ull, src, 2048);
+    SectorCacheLinkHead(slot);
+}
+
+// Reads [sector, sector+count) which are all missing from the cache, plus the readahead window.
+// The cache lock is released while the media is read.
+static bool SectorCacheFill(std::unique_lock<std::mutex>& lock, uint8_t* dest, psdisc_sec_t sector, uint32_t count, uint32_t readahead) {
+    if (s_media_sectors) {
+        readahead = (uint32_t)std::max<psdisc_sec_t>(0, std::min<psdisc_sec_t>(readahead, s_media_sectors - (sector + count)));
+    }
+    readahead = std::min(readahead, s_sector_cache_capacity / 2);
+
+    if (!readahead) {
+        lock.unlock();
+        bool ok = ReadSectorsUncached(dest, sector, count);
+        lock.lock();
+        if (!ok) return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            SectorCacheInsert(sector + i, dest + i * 2048);
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> buf((count + readahead) * 2048ull);
+    lock.unlock();
+    bool ok = ReadSectorsUncached(buf.data(), sector, count + readahead);
+    lock.lock();
+    if (!ok) {
+        // readahead past the end of a track (or of the media) isn't an error, retry the exact request.
+        return SectorCacheFill(lock, dest, sector, count, 0);
+    }
+
+    for (uint32_t i = 0; i < count + readahead; ++i) {
+        SectorCacheInsert(sector + i, buf.data() + i * 2048);
+    }
+    memcpy(dest, buf.data(), count * 2048ull);
+    s_sector_cache_stats.readahead += readahead;
+    return true;
+}
+
+// Thread safe: also called by the async read workers.
+// Prefetches don't take part in the sequential readahead detection of the HLE reads.
+static bool ReadSectorsCached(void* dest, psdisc_sec_t sector, int nSectors, bool prefetch = false) {
+    if (nSectors <= 0) return true;
+
+#if HLE_PCSX_IFC
+    // the page cache already is the cache
+    if (MediaIsMapped()) {
+        return ReadSectorsUncached(dest, sector, nSectors);
+    }
+#endif
+
+    std::unique_lock<std::mutex> lock(s_sector_cache_mutex);
+
+    // Reads which would flush most of the cache go straight to the media.
+    if ((uint32_t)nSectors > s_sector_cache_capacity / 2) {
+        s_sector_cache_stats.bypass += nSectors;
+        if (!prefetch) s_readahead_window = 0;
+        lock.unlock();
+        return ReadSectorsUncached(dest, sector, nSectors);
+    }
+
+    // adaptive readahead: grows while the reads are sequential
+    uint32_t readahead_window = 0;
+    if (!prefetch) {
+        if (sector == s_readahead_next) {
+            s_readahead_window = std::clamp(s_readahead_window * 2, kReadaheadMinSectors, kReadaheadMaxSectors);
+        }
+        else {
+            s_readahead_window = 0;
+        }
+        s_readahead_next = sector + nSectors;
+        readahead_window = s_readahead_window;
+    }
+
+    auto* wptr = (uint8_t*)dest;
+    int i = 0;
+    while (i < nSectors) {
+        if (auto* cached = SectorCacheLookup(sector + i)) {
+            memcpy(wptr + i * 2048ull, cached, 2048);
+            s_sector_cache_stats.hits++;
+            ++i;
+            continue;
+        }
+
+        // run of missing sectors
+        int run = 1;
+        while (i + run < nSectors && !s_sector_cache_map.count(sector + i + run)) {
+            ++run;
+        }
+        s_sector_cache_stats.misses += run;
+
+        // readahead only follows the last run of the request
+        auto readahead = (i + run == nSectors) ? readahead_window : 0;
+        if (!SectorCacheFill(lock, wptr + i * 2048ull, sector + i, run, readahead)) {
             return false;
         }
+        i += run;
+    }
+    return true;
+}
 
-        dbg_check(offset == 0);
-        dbg_check(sector);
-        dbg_check((length & 2047) == 0);
-        ds_cdimage->Seek(1, sector);
+bool psxFs_ReadSectorData2048(void* dest, psdisc_sec_t sector, int nSectors) {
+    if (s_indexed_generation != s_media_generation) {
+        psxFs_CacheFilesystem();
+    }
+    BootProfileOnDemand(sector, nSectors);
+    return ReadSectorsCached(dest, sector, nSectors);
+}
 
-        auto nSectors = length / 2048;
-        auto secread = ds_cdimage->Read(CDImage::ReadMode::DataOnly, length / 2048, dest);
-        return (secread == nSectors);
-    };
+// Returns the data of a sector, in place when the image is memory mapped, otherwise read into fallback
+// (2048 bytes). Returns nullptr on failure.
+const uint8_t* psxFs_ReadSectorSpan2048(psdisc_sec_t sector, uint8_t* fallback) {
+    if (s_indexed_generation != s_media_generation) {
+        psxFs_CacheFilesystem();
+    }
+    BootProfileOnDemand(sector, 1);
+#if HLE_PCSX_IFC
+    if (auto* span = MediaMapSector(sector)) {
+        return span;
+    }
 #endif
-    parser.ReadFilesystem(AddFile);
-    buildFilesByDirLUT();
+    return ReadSectorsCached(fallback, sector, 1) ? fallback : nullptr;
 }
 
-fs::path psxFs_Canonicalize(const char* src) {
-    if (!src) return {};
+// Streaming reads: whole sectors are read straight into the destination spans. Only a sector straddling two
+// spans, or the tail of the last one, goes through a bounce buffer. Runs are read in one go (large ones
+// bypass the sector cache) unless chunks are reported, in which case they're split by kStreamChunkSectors.
 
-    constexpr char mnt_cdrom[] = "cdrom:";
-    if (strncasecmp(src, mnt_cdrom, sizeof(mnt_cdrom) - 1) == 0) {
-        src += sizeof(mnt_cdrom) - 1;
+static const int kStreamChunkSectors = 64;
+
+static intmax_t SpansLength(const psxFsSpan* spans, int nspans) {
+    intmax_t len = 0;
+    for (int i = 0; i < nspans; ++i) {
+        len += spans[i].len;
     }
+    return len;
+}
 
-    // skip rooted slash. All paths are assumed to be rooted.
-    // (there is no CWD mechanic within the psFs)
+static bool ReadSpans(psdisc_sec_t sector, const psxFsSpan* spans, int nspans, const psxFsChunkCallback& on_chunk) {
+    uint8_t bounce[2048];
+    intmax_t pos = 0;       // within spans[si]
+    int si = 0;
+
+    while (si < nspans) {
+        auto* dest   = (uint8_t*)spans[si].dest + pos;
+        auto  remain = spans[si].len - pos;
+        if (remain <= 0) {
+            ++si;
+            pos = 0;
+            continue;
+        }
 
-    while (src[0] == '/' || src[0] == '\\') ++src;
+        if (remain >= 2048) {
+            auto n = remain / 2048;
+            if (on_chunk) {
+                n = std::min<intmax_t>(n, kStreamChunkSectors);
+            }
+            if (!ReadSectorsCached(dest, sector, (int)n)) {
+                return false;
+            }
+            sector += n;
+            pos    += n * 2048;
+            if (on_chunk) on_chunk(dest, n * 2048);
+            continue;
+        }
 
-    auto result = fs::path(src);
-    auto& uni = result.raw_modifiable_uni();
-    auto len = uni.length();
-    if (len < 3) return result;
-    if (uni[len-2] == ';') {
-        result.raw_modifiable_uni().resize(len-2);
-        result.raw_commit_modified();
+        if (!ReadSectorsCached(bounce, sector, 1)) {
+            return false;
+        }
+        ++sector;
+        for (intmax_t bpos = 0; bpos < 2048 && si < nspans; ) {
+            auto* wptr = (uint8_t*)spans[si].dest + pos;
+            auto  take = std::min<intmax_t>(spans[si].len - pos, 2048 - bpos);
+            memcpy(wptr, bounce + bpos, take);
+            if (on_chunk && take) on_chunk(wptr, take);
+            bpos += take;
+            pos  += take;
+            if (pos >= spans[si].len) {
+                ++si;
+                pos = 0;
+            }
+        }
     }
-    return result;
+    return true;
 }
 
-bool psxFs_ReadSectorData2048(void* dest, psdisc_sec_t sector, int nSectors) {
-    psxFs_CacheFilesystem();
-#if HLE_PCSX_IFC
-    return ReadData2048(dest, sector, 0, nSectors * 2048);
-#endif
+bool psxFs_ReadSpans(psdisc_sec_t sector, const psxFsSpan* spans, int nspans, const psxFsChunkCallback& on_chunk) {
+    if (s_indexed_generation != s_media_generation) {
+        psxFs_CacheFilesystem();
+    }
+    BootProfileOnDemand(sector, (int)((SpansLength(spans, nspans) + 2047) / 2048));
+    return ReadSpans(sector, spans, nspans, on_chunk);
+}
+
+// Executables: the header sector and the sectors following it are read in a single run (through a bounce
+// buffer, the destination is only known once the header is parsed), the body bytes already in are copied
+// out and the remainder is streamed with ReadSpans. nhead is updated to the number of sectors read in the
+// first run, ntail is the number of sectors streamed after it (the body length is only known from the header).
+
+static const int kExeHeadSectors = 16;
+static const int kMaxExeSpans    = 4;
+
+static bool ReadExecutable(psdisc_sec_t sector, int& nhead, int& ntail, const psxFsExeLayout& layout, const psxFsChunkCallback& on_chunk) {
+    static thread_local std::vector<uint8_t> s_head;
+    s_head.resize(kExeHeadSectors * 2048);
+
+    if (nhead < 1 || !ReadSectorsCached(s_head.data(), sector, nhead)) {
+        nhead = 1;
+        if (!ReadSectorsCached(s_head.data(), sector, 1)) {
+            log_error("(psxfs) can't read the executable header at sector %jd", JFMT(sector));
+            return false;
+        }
+    }
+
+    psxFsSpan spans[kMaxExeSpans];
+    auto nspans = layout(s_head.data(), spans, kMaxExeSpans);
+    if (nspans < 0) {
+        return false;
+    }
+
+    const uint8_t* src = s_head.data() + 2048;
+    intmax_t avail = (nhead - 1) * 2048ll;
+    int si = 0;
+    while (si < nspans && avail > 0) {
+        auto take = std::min(spans[si].len, avail);
+        memcpy(spans[si].dest, src, take);
+        if (on_chunk && take) on_chunk(spans[si].dest, take);
+        src   += take;
+        avail -= take;
+        if (take < spans[si].len) {
+            // the run ended within this span, which is completed from the next sector on
+            spans[si].dest = (uint8_t*)spans[si].dest + take;
+            spans[si].len -= take;
+            break;
+        }
+        ++si;
+    }
+    ntail = (int)((SpansLength(spans + si, nspans - si) + 2047) / 2048);
+    return ReadSpans(sector + nhead, spans + si, nspans - si, on_chunk);
+}
+
+// --------------------------------------------------------------------------------------
+// Async reads
+//
+// Requests (sector range into a buffer) are queued to a small pool of worker threads, so that the caller
+// can overlap its own work with the media access. Reads go through the sector cache. The completion
+// callback runs on the thread which reaps the request (psxFs_PollRead, psxFs_WaitRead or psxFs_ReapReads),
+// never on a worker, so it's free to touch the emulator state. The destination must stay valid (and the
+// guest must not run, if it's guest memory) until the request is reaped.
+//
+// Without workers (HleSetFsAsyncWorkers(0)) requests are served synchronously at submission.
+
+struct AsyncReadRequest
+{
+    int                 id;
+    void*               dest;
+    psdisc_sec_t        sector;
+    int                 count;
+    std::vector<psxFsSpan>  spans;      // streaming read (dest and count unused)
+    psxFsExeLayout      layout;         // executable: spans given by the header (count is the first run)
+    int                 tail;           // executable: sectors streamed after the first run
+    psxFsChunkCallback  on_chunk;
+    psxFsReadCallback   callback;
+    bool                prefetch;       // fire and forget: only fills the sector cache, never reaped
+    bool                done;
+    bool                ok;
+};
+
+using AsyncReadRequestPtr = std::shared_ptr<AsyncReadRequest>;
+
+static bool AsyncReadExecute(AsyncReadRequest& req);
+
+struct AsyncReadPool
+{
+    std::mutex                                      mutex;
+    std::condition_variable                         work_cv;
+    std::condition_variable                         done_cv;
+    std::deque<AsyncReadRequestPtr>                 queue;
+    std::unordered_map<int, AsyncReadRequestPtr>    requests;       // submitted and not reaped yet
+    std::vector<std::thread>                        workers;
 #if HLE_MEDNAFEN_IFC
-    return s_cur_cdif->ReadSector((uint8_t*)dest, sector, nSectors) != 0;
+    int                                             num_workers = 0;    // see HleSetFsAsyncWorkers
+#else
+    int                                             num_workers = 2;
 #endif
+    int                                             next_id = 1;
+    int                                             busy = 0;
+    int                                             prefetch_pending = 0;  // sectors
+    bool                                            quit = false;
 
-#if HLE_DUCKSTATION_IFC
-    ds_cdimage->Seek(1, sector);
+    ~AsyncReadPool() {
+        Stop();
+    }
 
-    auto secread = ds_cdimage->Read(CDImage::ReadMode::DataOnly, nSectors, dest);
-    return (secread == nSectors);
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        work_cv.notify_all();
+        for (auto& th : workers) {
+            th.join();
+        }
+        workers.clear();
+        quit = false;
+    }
+
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (1) {
+            work_cv.wait(lock, [&] { return quit || !queue.empty(); });
+            if (quit) return;
+
+            auto req = queue.front();
+            queue.pop_front();
+            busy++;
+
+            lock.unlock();
+            bool ok;
+            if (req->prefetch) {
+                static thread_local std::vector<uint8_t> s_scratch;
+                s_scratch.resize(req->count * 2048ull);
+                ok = ReadSectorsCached(s_scratch.data(), req->sector, req->count, true);
+            }
+            else {
+                ok = AsyncReadExecute(*req);
+            }
+            lock.lock();
+
+            if (req->prefetch) {
+                prefetch_pending -= req->count;
+            }
+            busy--;
+            req->ok = ok;
+            req->done = true;
+            done_cv.notify_all();
+        }
+    }
+};
+
+static AsyncReadPool s_async;
+
+static bool AsyncReadExecute(AsyncReadRequest& req) {
+    if (req.layout) {
+        return ReadExecutable(req.sector, req.count, req.tail, req.layout, req.on_chunk);
+    }
+    if (!req.spans.empty()) {
+        return ReadSpans(req.sector, req.spans.data(), (int)req.spans.size(), req.on_chunk);
+    }
+    return ReadSectorsCached(req.dest, req.sector, req.count);
+}
+
+extern "C" void HleSetFsAsyncWorkers(int count) {
+    psxFs_DrainReads();
+    s_async.Stop();
+#if HLE_MEDNAFEN_IFC
+    // The CDIF is the emulator's own, shared with its CD-ROM controller: it can't be read from a worker.
+    if (count > 0) {
+        log_error("(psxfs) async workers aren't supported on Mednafen, reads stay synchronous");
+    }
+    count = 0;
 #endif
+    s_async.num_workers = std::max(count, 0);
+}
+
+static int AsyncReadSubmit(const AsyncReadRequestPtr& req) {
+    if (!s_async.num_workers) {
+        req->ok     = AsyncReadExecute(*req);
+        req->done   = true;
+    }
+
+    std::unique_lock<std::mutex> lock(s_async.mutex);
+    req->id = s_async.next_id++;
+    if (s_async.next_id <= 0) s_async.next_id = 1;
+    s_async.requests.insert({req->id, req});
+
+    if (!req->done) {
+        if (s_async.workers.empty()) {
+            for (int i = 0; i < s_async.num_workers; ++i) {
+                s_async.workers.emplace_back([] { s_async.WorkerLoop(); });
+            }
+        }
+        s_async.queue.push_back(req);
+        s_async.work_cv.notify_one();
+    }
+    return req->id;
+}
+
+int psxFs_SubmitRead(void* dest, psdisc_sec_t sector, int nSectors, psxFsReadCallback callback) {
+    if (s_indexed_generation != s_media_generation) {
+        psxFs_CacheFilesystem();
+    }
+    BootProfileOnDemand(sector, nSectors);
+
+    auto req = std::make_shared<AsyncReadRequest>();
+    req->dest       = dest;
+    req->sector     = sector;
+    req->count      = nSectors;
+    req->callback   = std::move(callback);
+    return AsyncReadSubmit(req);
+}
+
+// Streaming variant of psxFs_SubmitRead. The spans are copied, the memory they point to must stay valid
+// until the request is reaped.
+int psxFs_SubmitSpans(psdisc_sec_t sector, const psxFsSpan* spans, int nspans, psxFsChunkCallback on_chunk, psxFsReadCallback callback) {
+    if (s_indexed_generation != s_media_generation) {
+        psxFs_CacheFilesystem();
+    }
+    BootProfileOnDemand(sector, (int)((SpansLength(spans, nspans) + 2047) / 2048));
+
+    auto req = std::make_shared<AsyncReadRequest>();
+    req->sector     = sector;
+    req->spans.assign(spans, spans + nspans);
+    req->on_chunk   = std::move(on_chunk);
+    req->callback   = std::move(callback);
+    return AsyncReadSubmit(req);
+}
+
+// Loads an executable with a single call: the header and the start of the body are read in one go (see
+// ReadExecutable), `layout` gives the destination of the body, the rest of which is then streamed into it.
+// Everything runs on the async workers, `layout` included. Returns the request id (see psxFs_WaitRead): the
+// request fails if the header can't be read (`layout` isn't called then) or if `layout` returns a negative
+// count.
+int psxFs_SubmitExecutable(psdisc_sec_t sector, psxFsExeLayout layout, psxFsChunkCallback on_chunk) {
+    if (s_indexed_generation != s_media_generation) {
+        psxFs_CacheFilesystem();
+    }
+
+    // Clipped to the end of the media, the header alone is retried if the whole run can't be read.
+    intmax_t nhead = kExeHeadSectors;
+    if (s_media_sectors > sector) {
+        nhead = std::min<intmax_t>(nhead, (intmax_t)(s_media_sectors - sector));
+    }
+    BootProfileOnDemand(sector, (int)nhead);
+
+    auto req = std::make_shared<AsyncReadRequest>();
+    req->sector     = sector;
+    req->count      = (int)nhead;
+    req->layout     = std::move(layout);
+    req->on_chunk   = std::move(on_chunk);
+    return AsyncReadSubmit(req);
+}
+
+// Caller holds s_async.mutex. Removes the request and runs its callback (with the lock released).
+static bool AsyncReadReap(std::unique_lock<std::mutex>& lock, const AsyncReadRequestPtr& req) {
+    s_async.requests.erase(req->id);
+    if (req->layout) {
+        BootProfileOnDemand(req->sector + req->count, req->tail);
+    }
+    if (req->callback) {
+        lock.unlock();
+        req->callback(req->ok);
+        lock.lock();
+    }
+    return req->ok;
+}
+
+// Returns true once the request completed (its result is stored in ok).
+bool psxFs_PollRead(int id, bool& ok) {
+    std::unique_lock<std::mutex> lock(s_async.mutex);
+    auto it = s_async.requests.find(id);
+    if (it == s_async.requests.end()) {
+        dbg_abort("psxFs_PollRead: unknown request");
+        ok = false;
+        return true;
+    }
+    auto req = it->second;
+    if (!req->done) {
+        return false;
+    }
+    ok = AsyncReadReap(lock, req);
+    return true;
+}
+
+bool psxFs_WaitRead(int id) {
+    std::unique_lock<std::mutex> lock(s_async.mutex);
+    auto it = s_async.requests.find(id);
+    if (it == s_async.requests.end()) {
+        dbg_abort("psxFs_WaitRead: unknown request");
+        return false;
+    }
+    auto req = it->second;
+    s_async.done_cv.wait(lock, [&] { return req->done; });
+    return AsyncReadReap(lock, req);
+}
+
+// Runs the callbacks of all the completed requests.
+void psxFs_ReapReads() {
+    std::unique_lock<std::mutex> lock(s_async.mutex);
+    std::vector<AsyncReadRequestPtr> done;
+    for (auto& it : s_async.requests) {
+        if (it.second->done) done.push_back(it.second);
+    }
+    for (auto& req : done) {
+        AsyncReadReap(lock, req);
+    }
+}
+
+// Waits until no read is in flight (requests stay pending until reaped).
+void psxFs_DrainReads() {
+    std::unique_lock<std::mutex> lock(s_async.mutex);
+    s_async.done_cv.wait(lock, [] { return s_async.queue.empty() && !s_async.busy; });
+}
+
+void psxFs_PrintCacheStats() { // Called from GDB
+    auto& st = s_sector_cache_stats;
+    log_host("sector cache: %u/%u sectors, hits %ju misses %ju readahead %ju bypass %ju prefetch %ju",
+        s_sector_cache_used, s_sector_cache_capacity,
+        (uintmax_t)st.hits, (uintmax_t)st.misses, (uintmax_t)st.readahead, (uintmax_t)st.bypass, (uintmax_t)st.prefetch
+    );
+}
+
+// --------------------------------------------------------------------------------------
+// File-aware prefetch for the emulator CD path
+//
+// Sector numbers are relative to track 1 (like the rest of this module), not absolute LBAs.
+//
+// The emulator CD-ROM controller reports the sectors it reads (HleFsOnCdSectorRead). The sector is mapped
+// to a file of the disc index, and the rest of that file (or the next file in disc order, once the reader
+// reached the end of the file) is read on the async workers, which warms the host caches (sector cache,
+// image page cache) ahead of the emulated reads. Sectors outside of any file (eg. XA streams not listed in
+// the filesystem) get a plain sequential window.
+//
+// Prefetching is done by window: a new window is only planned once the reader seeks out of the current
+// one, or gets within kCdPrefetchLowWater sectors of its end.
+
+static const uint32_t kCdPrefetchWindow     = 256;      // sectors per planned window (512KB)
+static const uint32_t kCdPrefetchLowWater   = 64;
+static const uint32_t kCdPrefetchChunk      = 32;       // sectors per async request
+static const int      kCdPrefetchMaxPending = 1024;     // sectors queued on the workers
+
+static bool         s_cd_prefetch_enabled = true;
+static uint32_t     s_cd_prefetch_generation;
+static psdisc_sec_t s_cd_prefetch_begin;
+static psdisc_sec_t s_cd_prefetch_end;
+
+extern "C" void HleSetFsCdPrefetch(int enable) {
+    s_cd_prefetch_enabled = !!enable;
+}
+
+// Returns false if the workers are too far behind (the window will be planned again on the next read).
+static bool CdPrefetchSubmit(psdisc_sec_t begin, psdisc_sec_t end) {
+    std::unique_lock<std::mutex> lock(s_async.mutex);
+    if (s_async.prefetch_pending > kCdPrefetchMaxPending) {
+        return false;
+    }
+
+    if (s_async.workers.empty()) {
+        for (int i = 0; i < s_async.num_workers; ++i) {
+            s_async.workers.emplace_back([] { s_async.WorkerLoop(); });
+        }
+    }
+
+    for (auto sector = begin; sector < end; sector += kCdPrefetchChunk) {
+        auto req = std::make_shared<AsyncReadRequest>();
+        req->sector     = sector;
+        req->count      = (int)std::min<psdisc_sec_t>(kCdPrefetchChunk, end - sector);
+        req->prefetch   = true;
+        s_async.queue.push_back(req);
+        s_async.prefetch_pending += req->count;
+    }
+    s_async.work_cv.notify_all();
+    lock.unlock();
+
+    std::lock_guard<std::mutex> stats_lock(s_sector_cache_mutex);
+    s_sector_cache_stats.prefetch += end - begin;
+    return true;
+}
+
+extern "C" void HleFsOnCdSectorRead(uint32_t lba) {
+    BootProfileOnDemand(lba, 1);
+
+    IndexPoll(false);
+    if (!s_index) {
+        return;
+    }
+
+    // Nothing to prefetch with: prefetching synchronously would defeat the purpose.
+    if (!s_cd_prefetch_enabled || !s_async.num_workers) {
+        return;
+    }
+
+    if (s_cd_prefetch_generation != s_indexed_generation) {
+        s_cd_prefetch_generation = s_indexed_generation;
+        s_cd_prefetch_begin = s_cd_prefetch_end = 0;
+    }
+
+    psdisc_sec_t sector = lba;
+    bool in_window = (sector >= s_cd_prefetch_begin && sector < s_cd_prefetch_end);
+    if (in_window && (s_cd_prefetch_end - sector) > kCdPrefetchLowWater) {
+        return;
+    }
+
+    auto from = in_window ? s_cd_prefetch_end : sector + 1;
+    auto to   = from + kCdPrefetchWindow;
+
+    auto& idx = *s_index;
+    if (auto* fe = idx.FindFileBySector(sector)) {
+        auto file_end = fe->start_sector + (fe->len_bytes + 2047) / 2048;
+        if (from < file_end) {
+            to = std::min(to, file_end);
+        }
+        else {
+            // end of the file reached: next file in disc order
+            auto it = std::upper_bound(idx.extents.begin(), idx.extents.end(), from - 1, [](psdisc_sec_t sec, const SectorExtent& ext) {
+                return sec < ext.start_sector;
+            });
+            if (it == idx.extents.end()) {
+                to = from;
+            }
+            else {
+                from = it->start_sector;
+                to   = from + std::min<psdisc_sec_t>(it->sector_count, kCdPrefetchWindow);
+            }
+        }
+    }
+
+    if (s_media_sectors) {
+        to = std::min<psdisc_sec_t>(to, s_media_sectors);
+    }
+
+    if (from < to && !CdPrefetchSubmit(from, to)) {
+        return;
+    }
+
+    s_cd_prefetch_begin = in_window ? s_cd_prefetch_begin : sector;
+    s_cd_prefetch_end   = std::max(from, to);
+}
+
+// Lets the emulator serve a 2048-byte data sector from the host cache. Returns 0 if it isn't cached.
+extern "C" int HleFsReadCachedSector(uint32_t lba, void* dest) {
+    std::lock_guard<std::mutex> lock(s_sector_cache_mutex);
+    if (auto* cached = SectorCacheLookup(lba)) {
+        memcpy(dest, cached, 2048);
+        return 1;
+    }
+    return 0;
+}
+
+// --------------------------------------------------------------------------------------
+// Boot profile
+//
+// The sector ranges read during the first seconds after a disc is indexed (HLE loads, plus the emulator CD
+// reads when they are reported) are recorded in order, and saved next to the index cache as
+// <fingerprint>.psxfsboot. On the following boots of the same disc the list is replayed on the async
+// workers ahead of the demand: the replay is kept at most half of the sector cache ahead of the last
+// recorded range the game actually read, so that prefetched data isn't evicted before it's used.
+// Each boot records a new profile (prefetches aren't recorded).
+
+struct BootProfileEntry
+{
+    int64_t         sector;
+    uint32_t        count;
+    uint32_t        pad;
+};
+
+struct BootProfileHeader
+{
+    char            magic[8];
+    uint32_t        version;
+    uint32_t        num_entries;
+    uint64_t        fingerprint;
+};
+
+static const char     kBootProfileMagic[8]      = { 'P','S','X','F','S','B','O','T' };
+static const uint32_t kBootProfileVersion       = 1;
+static const size_t   kBootProfileMaxEntries    = 8192;
+static const size_t   kBootProfileMatchWindow   = 16;       // entries searched ahead of the demand position
+
+static int                              s_boot_profile_seconds = 30;
+static bool                             s_boot_profile_recording;
+static uint64_t                         s_boot_profile_fingerprint;
+static std::chrono::steady_clock::time_point s_boot_profile_start;
+static std::vector<BootProfileEntry>    s_boot_profile;         // being recorded
+static std::vector<BootProfileEntry>    s_boot_replay;
+static size_t                           s_boot_replay_next;     // next entry to submit
+static size_t                           s_boot_replay_demand;   // entries before it were read by the game
+static int64_t                          s_boot_replay_ahead;    // sectors submitted ahead of the demand
+
+extern "C" void HleSetFsBootProfileSeconds(int seconds) {
+    s_boot_profile_seconds = std::max(seconds, 0);
+}
+
+static void BootProfileSave() {
+    s_boot_profile_recording = false;
+    if (s_boot_profile.empty() || s_index_cache_dir.empty()) return;
+
+    BootProfileHeader hdr = {};
+    memcpy(hdr.magic, kBootProfileMagic, sizeof(hdr.magic));
+    hdr.version         = kBootProfileVersion;
+    hdr.num_entries     = (uint32_t)s_boot_profile.size();
+    hdr.fingerprint     = s_boot_profile_fingerprint;
+
+    auto path = IndexCachePath(s_boot_profile_fingerprint, "psxfsboot");
+    auto tmppath = UniqueTempPath(path);
+    auto* fp = fopen(tmppath.c_str(), "wb");
+    if (!fp) {
+        log_error("(psxfs) can't write boot profile %s: %s", tmppath.c_str(), strerror(errno));
+        return;
+    }
+    fwrite(&hdr, 1, sizeof(hdr), fp);
+    fwrite(s_boot_profile.data(), sizeof(BootProfileEntry), s_boot_profile.size(), fp);
+
+    bool ok = !ferror(fp);
+    fclose(fp);
+    if (!ok || rename(tmppath.c_str(), path.c_str()) != 0) {
+        log_error("(psxfs) can't write boot profile %s", path.c_str());
+        remove(tmppath.c_str());
+        return;
+    }
+    log_host("(psxfs) saved boot profile %s (%u ranges)", path.c_str(), hdr.num_entries);
+}
+
+static void BootProfileLoad() {
+    auto path = IndexCachePath(s_boot_profile_fingerprint, "psxfsboot");
+    auto* fp = fopen(path.c_str(), "rb");
+    if (!fp) return;
+
+    BootProfileHeader hdr;
+    bool ok = fread(&hdr, 1, sizeof(hdr), fp) == sizeof(hdr)
+        && !memcmp(hdr.magic, kBootProfileMagic, sizeof(hdr.magic))
+        && hdr.version      == kBootProfileVersion
+        && hdr.fingerprint  == s_boot_profile_fingerprint
+        && hdr.num_entries  <= kBootProfileMaxEntries;
+    if (ok) {
+        s_boot_replay.resize(hdr.num_entries);
+        ok = fread(s_boot_replay.data(), sizeof(BootProfileEntry), hdr.num_entries, fp) == hdr.num_entries;
+    }
+    fclose(fp);
+
+    if (!ok) {
+        log_error("(psxfs) ignoring invalid boot profile %s", path.c_str());
+        s_boot_replay.clear();
+        return;
+    }
+    log_host("(psxfs) replaying boot profile %s (%u ranges)", path.c_str(), hdr.num_entries);
+}
+
+static void BootProfilePump() {
+    auto limit = (int64_t)std::max(s_sector_cache_capacity / 2, kCdPrefetchWindow);
+
+    while (s_boot_replay_next < s_boot_replay.size()) {
+        auto& entry = s_boot_replay[s_boot_replay_next];
+        if (s_boot_replay_ahead && s_boot_replay_ahead + entry.count > limit) {
+            break;
+        }
+        if (!CdPrefetchSubmit(entry.sector, entry.sector + entry.count)) {
+            break;
+        }
+        s_boot_replay_ahead += entry.count;
+        s_boot_replay_next++;
+    }
+}
+
+// Called before the media changes
+static void BootProfileEnd() {
+    if (s_boot_profile_recording) {
+        BootProfileSave();
+    }
+
+    s_boot_profile.clear();
+    s_boot_replay.clear();
+    s_boot_replay_next      = 0;
+    s_boot_replay_demand    = 0;
+    s_boot_replay_ahead     = 0;
+}
+
+// Called once a new media is identified
+static void BootProfileBegin(uint64_t fingerprint) {
+    BootProfileEnd();
+
+    if (!s_boot_profile_seconds || s_index_cache_dir.empty()) {
+        return;
+    }
+
+    s_boot_profile_recording    = true;
+    s_boot_profile_fingerprint  = fingerprint;
+    s_boot_profile_start        = std::chrono::steady_clock::now();
+
+    if (s_async.num_workers) {
+        BootProfileLoad();
+        BootProfilePump();
+    }
+}
+
+static void BootProfileOnDemand(psdisc_sec_t sector, int count) {
+    if (!s_boot_profile_recording || count <= 0) {
+        return;
+    }
+
+    // record, merging sequential reads
+    if (!s_boot_profile.empty() && s_boot_profile.back().sector + s_boot_profile.back().count == sector) {
+        s_boot_profile.back().count += count;
+    }
+    else if (s_boot_profile.empty() || sector < s_boot_profile.back().sector
+        || sector + count > s_boot_profile.back().sector + s_boot_profile.back().count) {
+        if (s_boot_profile.size() < kBootProfileMaxEntries) {
+            s_boot_profile.push_back({ sector, (uint32_t)count, 0 });
+        }
+    }
+
+    // replay: the demand caught up with the entries up to the matching one
+    auto end = std::min(s_boot_replay_next, s_boot_replay_demand + kBootProfileMatchWindow);
+    for (auto i = s_boot_replay_demand; i < end; ++i) {
+        auto& entry = s_boot_replay[i];
+        if (sector < entry.sector + entry.count && sector + count > entry.sector) {
+            for (; s_boot_replay_demand <= i; ++s_boot_replay_demand) {
+                s_boot_replay_ahead -= s_boot_replay[s_boot_replay_demand].count;
+            }
+            break;
+        }
+    }
+    BootProfilePump();
+
+    auto elapsed = std::chrono::steady_clock::now() - s_boot_profile_start;
+    if (elapsed >= std::chrono::seconds(s_boot_profile_seconds)) {
+        BootProfileSave();
+    }
+}
 
+// Saves the boot profile being recorded, if any (eg. when the emulator shuts down early).
+extern "C" void HleFsFlushBootProfile() {
+    if (s_boot_profile_recording) {
+        BootProfileSave();
+    }
 }
 
 // Result from this read can be fed directly into CDIF::ReadSector() by caller.
 // returns 0 on failure (sector 0 is never a valid position for a cdrom file).
 psdisc_sec_t psxFs_GetFileSector(const char* path) {
-    auto canon = psxFs_Canonicalize(path);
-    if (auto it = m_filesByFullpath.find(canon); it != m_filesByFullpath.end()) {
-        return it->second.start_sector;
-    }
-    log_error("psxFs_GetFileSector: Failed to find %s (%s)\n", path, canon.c_str());
-    for (const auto& it : m_filesByFullpath) {
-        log_host(" > %s", it.first.c_str());
+    fileEnt_t item;
+    if (psxFs_FindFile(path, item)) {
+        return item.start_sector;
     }
+    psxFs_LogMiss("psxFs_GetFileSector", path);
     return 0;
 }
 
-bool psxFs_LoadFile(const char* path, std::vector<uint8_t>& dest) {
-    auto canon = psxFs_Canonicalize(path);
+// returns -1 if the file doesn't exist.
+intmax_t psxFs_GetFileSize(const char* path) {
+    fileEnt_t item;
+    if (psxFs_FindFile(path, item)) {
+        return item.len_bytes;
+    }
+    psxFs_LogMiss("psxFs_GetFileSize", path);
+    return -1;
+}
+
+// Looks up the start sector and size of a file in one go. returns false if the file doesn't exist.
+bool psxFs_GetFileExtent(const char* path, psdisc_sec_t& sector, intmax_t& size) {
+    fileEnt_t item;
+    if (psxFs_FindFile(path, item)) {
+        sector  = item.start_sector;
+        size    = item.len_bytes;
+        return true;
+    }
+    psxFs_LogMiss("psxFs_GetFileExtent", path);
+    return false;
+}
+
+// Lists the entries of a directory (its own range of the index). The partial index parses the directory
+// on demand.
+bool psxFs_ListDirectory(const char* path, std::vector<psxFsDirEntry>& dest) {
+    dest.clear();
+
+    IndexPoll(false);
+    std::unique_lock<std::mutex> lock(s_builder.mutex, std::defer_lock);
+    const DiscIndex* idx = s_index.get();
+    const fileEnt_t* dir = nullptr;
+    if (idx) {
+        dir = idx->FindFile(path);
+    }
+    else if (s_builder.running) {
+        auto key = PathKeyString(path);
+        lock.lock();
+        if (IndexParsePath(lock, key, true)) {
+            idx = s_builder.build.get();
+            dir = &idx->files[s_builder.paths[key]];
+        }
+    }
+
+    if (!dir || dir->type != FILETYPE_DIR) {
+        psxFs_LogMiss("psxFs_ListDirectory", path);
+        return false;
+    }
 
-    log_host("Here it is:");
-    log_host(" > %s", path);
-    log_host(" > %s", canon.uni_string().c_str());
+    auto range = idx->children.find(dir->start_sector);
+    if (range == idx->children.end()) {
+        return true;
+    }
+    for (auto id = range->second.first; id < range->second.second; ++id) {
+        auto& fe = idx->files[id];
+        psxFsDirEntry ent = {};
+        snprintf(ent.name, sizeof(ent.name), "%s", idx->name(fe));
+        ent.sector  = (uint32_t)fe.start_sector;
+        ent.size    = (uint32_t)fe.len_bytes;
+        ent.is_dir  = fe.type == FILETYPE_DIR;
+        dest.push_back(ent);
+    }
+    return true;
+}
 
-    if (auto it = m_filesByFullpath.find(canon); it != m_filesByFullpath.end()) {
-        auto& item = it->second;
-        auto len_in_sectors = (item.len_bytes + 2047) / 2048;
-        dest.resize(len_in_sectors * 2048);
+// Streams the file into the spans, stopping at the end of the file or of the spans.
+bool psxFs_LoadFile(const char* path, const psxFsSpan* spans, int nspans, const psxFsChunkCallback& on_chunk) {
+    log_host("psxFs_LoadFile: %s", path);
+
+    fileEnt_t item;
+    if (psxFs_FindFile(path, item)) {
+        std::vector<psxFsSpan> clipped;
+        intmax_t remain = item.len_bytes;
+        for (int i = 0; i < nspans && remain > 0; ++i) {
+            clipped.push_back({ spans[i].dest, std::min(spans[i].len, remain) });
+            remain -= clipped.back().len;
+        }
 
-        auto read_result = psxFs_ReadSectorData2048(dest.data(), item.start_sector, len_in_sectors);
+        auto read_result = psxFs_ReadSpans(item.start_sector, clipped.data(), (int)clipped.size(), on_chunk);
         dbg_check(read_result);
         return read_result;
     }
+    psxFs_LogMiss("psxFs_LoadFile", path);
     return 0;
 }
 
+bool psxFs_LoadFile(const char* path, std::vector<uint8_t>& dest) {
+    fileEnt_t item;
+    if (!psxFs_FindFile(path, item)) {
+        psxFs_LogMiss("psxFs_LoadFile", path);
+        return 0;
+    }
+
+    dest.resize((item.len_bytes + 2047) / 2048 * 2048);
+    psxFsSpan span = { dest.data(), (intmax_t)dest.size() };
+    return psxFs_LoadFile(path, &span, 1, {});
+}
+
 bool psxFs_LoadExecutableHeader(const char* path, PSX_EXE_HEADER& dest) {
     psxFs_CacheFilesystem();
-    auto canon = psxFs_Canonicalize(path);
+    log_host("psxFs_LoadExecutableHeader: %s", path);
 
-    log_host("Here it is:");
-    log_host(" > %s", path);
-    log_host(" > %s", canon.uni_string().c_str());
-
-    if (auto it = m_filesByFullpath.find(canon); it != m_filesByFullpath.end()) {
-        auto& item = it->second;
-        //log_host(" > sector = %jd", JFMT(it->second.start_sector));
+    fileEnt_t item;
+    if (psxFs_FindFile(path, item)) {
         auto read_result = psxFs_ReadSectorData2048((uint8_t*)&dest, item.start_sector, 1);
         dbg_check(read_result);
         return read_result;
     }
-
+    psxFs_LogMiss("psxFs_LoadExecutableHeader", path);
     return 0;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <functional>
 
 // Typical Playstation executable has a 76 byte header laid out as:
 //   [16 bytes]        [60 bytes]
@@ -31,3 +32,45 @@ struct EXEC_DESCRIPTOR {
     uint32_t SavedRA;
     uint32_t SavedS0;
 };
+
+// SYSTEM.CNF settings of the current disc. They are stored along with the filesystem index so that a cached
+// index spares the SYSTEM.CNF read and parsing as well.
+struct PSX_BOOT_INFO {
+    uint32_t valid;             // 0 until SYSTEM.CNF has been parsed for the current disc
+    uint32_t has_cnf;           // SYSTEM.CNF was found
+    uint32_t has_tcb;
+    uint32_t has_event;
+    uint32_t tcb;
+    uint32_t event;
+    char     boot[256];         // BOOT rvalue, empty if not set
+    char     game_code[32];     // derived from BOOT (SCES_123.45 -> SCES-12345)
+};
+
+// Completion callback of an async disc read (see psxFs_SubmitRead)
+using psxFsReadCallback = std::function<void(bool ok)>;
+
+// Destination of a streaming read: consecutive file bytes fill each span in turn (eg. a guest RAM range
+// split where it wraps around the physical RAM).
+struct psxFsSpan
+{
+    void*       dest;
+    intmax_t    len;
+};
+
+// Called each time a chunk of a streaming read has been written (dest lies within one span). Runs on an
+// async worker for submitted reads.
+using psxFsChunkCallback = std::function<void(void* dest, intmax_t len)>;
+
+// Maps the header sector of an executable to the destination spans of its body (the sectors following the
+// header), returns the number of spans or -1 if the header isn't valid. Runs on an async worker, see
+// psxFs_SubmitExecutable.
+using psxFsExeLayout = std::function<int(const uint8_t* header, psxFsSpan* spans, int max_spans)>;
+
+// Entry of a disc directory listing (see psxFs_ListDirectory), in the order of the directory records.
+struct psxFsDirEntry
+{
+    char        name[32];       // without the ECMA-119 revision suffix
+    uint32_t    sector;
+    uint32_t    size;
+    bool        is_dir;
+};
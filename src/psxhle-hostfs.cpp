@@ -0,0 +1,223 @@
+#include "psxhle-filesystem.h"
+
+#include "icy_assert.h"
+#include "icy_log.h"
+#include "jfmt.h"
+#include "posix_file.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Host directory mount (pcdrv: / host:)
+//
+// Serves guest files straight from a directory of the host, so that homebrew or patched executables can be
+// run without rebuilding a disc image. Files are read-only and read with pread directly into guest memory,
+// like disc files. Host file handles aren't part of the savestate: files still open when a state is loaded
+// fail to read.
+//
+// A handle is the slot index tagged with a generation unique to its open (seeded per process), so a handle
+// restored from a savestate (saved by another process, or before its slot was reused) is rejected rather
+// than reading another file.
+
+namespace stdfs = std::filesystem;
+
+static const int kHostSlotBits = 8;
+static const int kHostTagBits  = 31 - kHostSlotBits;
+
+struct HostFile {
+    int         fd;             // posix fd, -1 if free
+    uint32_t    tag;
+};
+
+static std::string              s_host_mount_dir;
+static std::vector<HostFile>    s_host_files;
+static uint32_t                 s_host_generation;
+
+extern "C" void HleSetHostMountDir(const char* dir) {
+    s_host_mount_dir = dir ? dir : "";
+}
+
+static const char* HostPathTail(const char* path) {
+    constexpr char mnt_pcdrv[] = "pcdrv:";
+    constexpr char mnt_host[]  = "host:";
+    if (strncasecmp(path, mnt_pcdrv, sizeof(mnt_pcdrv) - 1) == 0) return path + sizeof(mnt_pcdrv) - 1;
+    if (strncasecmp(path, mnt_host,  sizeof(mnt_host)  - 1) == 0) return path + sizeof(mnt_host)  - 1;
+    return nullptr;
+}
+
+// true if the path is on the host mount (and a directory is mounted).
+bool psxFs_IsHostPath(const char* path) {
+    return path && !s_host_mount_dir.empty() && HostPathTail(path);
+}
+
+// Maps a guest path to the host: separators are normalized, the revision suffix is dropped and each component
+// is matched case insensitively (PS1 paths are uppercase). Paths escaping the mount are rejected.
+static bool HostResolvePath(const char* path, stdfs::path& dest) {
+    auto* tail = HostPathTail(path);
+    if (!tail || s_host_mount_dir.empty()) return false;
+
+    std::string rel(tail);
+    for (auto& c : rel) {
+        if (c == '\\') c = '/';
+    }
+    if (rel.size() >= 2 && rel[rel.size() - 2] == ';') {
+        rel.resize(rel.size() - 2);
+    }
+
+    dest = s_host_mount_dir;
+    size_t pos = 0;
+    while (pos < rel.size()) {
+        auto end = rel.find('/', pos);
+        if (end == std::string::npos) end = rel.size();
+        auto comp = rel.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (comp.empty() || comp == ".") continue;
+
+        // Anything that would make the join leave the mount: parent, drive ("C:"), absolute or rooted
+        // component (the separators were normalized above, a drive-relative name still has a ':')
+        stdfs::path comp_path(comp);
+        if (comp == ".." || comp.find(':') != std::string::npos
+            || comp_path.has_root_name() || comp_path.has_root_directory()) {
+            log_error("(hostfs) path escapes the mount: %s", path);
+            return false;
+        }
+
+        std::error_code ec;
+        auto next = dest / comp;
+        if (!stdfs::exists(next, ec)) {
+            for (auto& ent : stdfs::directory_iterator(dest, ec)) {
+                if (strcasecmp(ent.path().filename().string().c_str(), comp.c_str()) == 0) {
+                    next = ent.path();
+                    break;
+                }
+            }
+        }
+        dest = next;
+    }
+    return true;
+}
+
+static HostFile* HostLookup(int handle) {
+    auto slot = (size_t)handle & ((1u << kHostSlotBits) - 1);
+    if (handle < 0 || slot >= s_host_files.size()) return nullptr;
+    auto& file = s_host_files[slot];
+    if (file.fd < 0 || file.tag != ((uint32_t)handle >> kHostSlotBits)) return nullptr;
+    return &file;
+}
+
+// returns a handle, -1 if the file doesn't exist.
+int psxFs_HostOpen(const char* path, intmax_t& size) {
+    stdfs::path host;
+    std::error_code ec;
+    if (!HostResolvePath(path, host) || !stdfs::is_regular_file(host, ec)) {
+        log_host("(hostfs) not found: %s", path);
+        return -1;
+    }
+
+    int fd = posix_open(host.string().c_str(), O_RDONLY, DEFFILEMODE);
+    if (fd < 0) {
+        log_error("(hostfs) open failed: %s: %s", host.string().c_str(), strerror(errno));
+        return -1;
+    }
+    size = (intmax_t)stdfs::file_size(host, ec);
+
+    log_host("(hostfs) open %s -> %s (%jd bytes)", path, host.string().c_str(), JFMT(size));
+
+    size_t slot = 0;
+    while (slot < s_host_files.size() && s_host_files[slot].fd >= 0) ++slot;
+    if (slot >= (1u << kHostSlotBits)) {
+        log_error("(hostfs) too many open files: %s", path);
+        posix_close(fd);
+        return -1;
+    }
+    if (slot == s_host_files.size()) {
+        s_host_files.push_back({ -1, 0 });
+    }
+
+    if (!s_host_generation) {
+        s_host_generation = (uint32_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+    auto tag = ++s_host_generation & ((1u << kHostTagBits) - 1);
+    s_host_files[slot] = { fd, tag };
+    return (int)((tag << kHostSlotBits) | slot);
+}
+
+void psxFs_HostClose(int handle) {
+    if (auto* file = HostLookup(handle)) {
+        posix_close(file->fd);
+        file->fd = -1;
+    }
+}
+
+void psxFs_HostCloseAll() {
+    for (auto& file : s_host_files) {
+        if (file.fd >= 0) {
+            posix_close(file.fd);
+            file.fd = -1;
+        }
+    }
+}
+
+// Closes the files that aren't referenced by any of the handles (after a state load).
+void psxFs_HostCloseUnreferenced(const int* handles, int count) {
+    for (size_t slot = 0; slot < s_host_files.size(); ++slot) {
+        auto& file = s_host_files[slot];
+        if (file.fd < 0) continue;
+        auto handle = (int)((file.tag << kHostSlotBits) | slot);
+        if (std::find(handles, handles + count, handle) == handles + count) {
+            posix_close(file.fd);
+            file.fd = -1;
+        }
+    }
+}
+
+// Reads from offset pos straight into the spans. returns the number of bytes read (short at the end of the
+// file), -1 on error.
+intmax_t psxFs_HostRead(int handle, intmax_t pos, const psxFsSpan* spans, int nspans) {
+    auto* file = HostLookup(handle);
+    if (!file) {
+        log_error("(hostfs) read from a closed or stale handle %08x", handle);
+        return -1;
+    }
+
+    intmax_t total = 0;
+    for (int i = 0; i < nspans; ++i) {
+        auto res = posix_pread(file->fd, spans[i].dest, spans[i].len, pos + total);
+        if (res < 0) {
+            log_error("(hostfs) read failed: %s", strerror(errno));
+            return -1;
+        }
+        total += res;
+        if (res < spans[i].len) break;
+    }
+    return total;
+}
+
+// Lists a host directory. The entries are sorted by name, sizes are clamped to 32 bits and the sector field
+// is unused (0).
+bool psxFs_HostListDirectory(const char* path, std::vector<psxFsDirEntry>& dest) {
+    dest.clear();
+
+    stdfs::path host;
+    std::error_code ec;
+    if (!HostResolvePath(path, host) || !stdfs::is_directory(host, ec)) {
+        return false;
+    }
+
+    for (auto& ent : stdfs::directory_iterator(host, ec)) {
+        psxFsDirEntry item = {};
+        snprintf(item.name, sizeof(item.name), "%s", ent.path().filename().string().c_str());
+        item.is_dir = ent.is_directory(ec);
+        item.size   = item.is_dir ? 0 : (uint32_t)std::min<uintmax_t>(ent.file_size(ec), UINT32_MAX);
+        dest.push_back(item);
+    }
+    std::sort(dest.begin(), dest.end(), [](const psxFsDirEntry& a, const psxFsDirEntry& b) {
+        return strcmp(a.name, b.name) < 0;
+    });
+    return true;
+}
@@ -1,5 +1,6 @@
 
 #include "psxhle-emu-ifc.h"
+#include "psdisc-endian.h"
 #include "icy_assert.h"
 
 #include <cstdint>
@@ -14,74 +15,70 @@
 //
 // Using the VM's stack machine is of critical importance to ensure proper handling of thread
 // context switching which may occur during open-ended execution of interpreter.
+//
+// Frame layout (from the new $sp upward):
+//  * 16 bytes of shadow space
+//  * `count` words of HLE call state
+//  * saved $ra
+//
+// Convention for HLE subroutines (eg. DeliverEvent) in yield mode: the caller pushes its own frame
+// first (so $ra points to its continuation), then the subroutine completes with `pc0 = ra`, either
+// immediately or once the last guest callback returned.
 
 // Pedantic: the PSX expects 16 bytes of shadow space below the current callstack.
 //   Mostly things work without this, because it was only meant for use by debug builds to shadow values
 //   passd by register ($a0 -> $a4).  --jstine
+static const u32 kShadowSpace = 0x10;
 
-static void StackPush(u32 val) {
-    sp -= 4;
-    psxMu32ref(sp) = val;
-}
+void HleYieldPush(HleYieldUid resume, const u32* state, u32 count) {
+    sp -= (count + 1) * 4 + kShadowSpace;
 
-static void StackPop(u32& val) {
-    val = psxMu32ref(sp);
-    sp += 4;
-}
+    u32 frame = sp + kShadowSpace;
+    for (u32 i = 0; i < count; i++)
+        StoreToLE(psxMu32ref(frame + i * 4), state[i]);
+    StoreToLE(psxMu32ref(frame + count * 4), ra);
 
-static HleYieldUid softCallYield(HleYieldUid id, u32 pc) {
-    dbg_check ((id & 15) == 0);
-
-    StackPush(ra);
-    sp -= 0x10;     // shadow space (see notes earlier)
-
-    // perform equivalent of JAL -- update $ra and set PC.
-    ra = kSoftCallBaseRetAddr | id;
-    pc0 = pc;
-    return id;
+    // perform the first half of a JAL -- the caller sets PC.
+    ra = kSoftCallBaseRetAddr | resume;
 }
 
+void HleYieldPop(u32* state, u32 count) {
+    u32 frame = sp + kShadowSpace;
+    for (u32 i = 0; i < count; i++)
+        state[i] = LoadFromLE(psxMu32ref(frame + i * 4));
+    ra = LoadFromLE(psxMu32ref(frame + count * 4));
 
-static void softCallResume() {
-    sp += 0x10;
-    StackPop(ra);
+    sp += (count + 1) * 4 + kShadowSpace;
 }
 
-static void HleCallYield(HleYieldUid id) {
-    StackPush(ra);
-    ra = kSoftCallBaseRetAddr | id;
-}
+HLE_BIOS_TABLE biosKernel = {};
 
-static void HleCallResume() {
-    StackPop(ra);
-}
+void HleYieldResume(HleYieldUid uid) {
+    HleBiosFnptr fn = nullptr;
+    auto call = HleGetYieldCall(uid);
 
-static bool HleYieldCheck(HleYieldUid id) {
-    auto pc = pc0;
-    if (IsHlePC(pc)) {
-        if (id == 0) return 0;
-        return (int)id == HleGetCallId(pc);
+    switch (HleGetYieldThunk(uid)) {
+        case 0xA0:              fn = biosA0[call];      break;
+        case 0xB0:              fn = biosB0[call];      break;
+        case 0xC0:              fn = biosC0[call];      break;
+        case HLE_THUNK_KERNEL:  fn = biosKernel[call];  break;
+        default: break;
     }
-    return 1;
-}
 
-#if 0
-static void HLEcb_DeliverEvent_Resume() {
-    dbg_check (HleYieldCheck(SCRI_DeliverEvent_Resume));
-    softCallResume();
-    pc0 = ra;
-}
+    // A zero yield state is the entry point of the call, never a valid resume point.
+    if (!fn || HleGetYieldState(uid) == 0) {
+        PSXBIOS_LOG("ERROR: invalid HLE resume address %08x (ra=%08x sp=%08x)", kSoftCallBaseRetAddr | uid, ra, sp);
+        dbg_abort();
+        return;
+    }
 
-static SoftCallReturnId DeliverEventYield(u32 ev, u32 spec) {
-    if (EventCB[ev][spec].status != EvStACTIVE) return SCRI_None;
+    fn(uid);
+}
 
-//	EventCB[ev][spec].status = EvStALREADY;
-    if (EventCB[ev][spec].mode == EvMdINTR) {
-        return softCallYield(SCRI_DeliverEvent_Resume, EventCB[ev][spec].fhandler);
-    }
-    else {
-        EventCB[ev][spec].status = EvStALREADY;
-        return SCRI_None;
+void HleYieldTrampoline() {
+    // Resumed calls frequently complete by returning to another suspended call (eg. DeliverEvent
+    // without callbacks returning to the exception handler). No need to bounce through the CPU loop.
+    while (IsHlePC(pc0)) {
+        HleYieldResume(HleGetCallId(pc0));
     }
 }
-#endif